@@ -19,6 +19,7 @@
 #ifndef RestCore_TRestTrack
 #define RestCore_TRestTrack
 
+#include <TMath.h>
 #include <TObject.h>
 #include <TRestVolumeHits.h>
 #include <TVector3.h>
@@ -35,20 +36,53 @@ class TRestTrack {
     // Hit volumes
     TRestVolumeHits fVolumeHits;  ///< Hit volumes that define a track
 
+    mutable UChar_t fHitsType = 0;            //! Projection flags shared by all the hits (HitsTypeFlag)
+    mutable Bool_t fHitsTypeUpdated = false;  //!
+
+    // Quantities derived from the hits, filled together by UpdateMoments
+    mutable TVector3 fMeanPosition;          //!
+    mutable TVector3 fBoundingBoxMin;        //!
+    mutable TVector3 fBoundingBoxMax;        //!
+    mutable Double_t fSigmaX = 0;            //!
+    mutable Double_t fSigmaY = 0;            //!
+    mutable Double_t fSigmaZ2 = 0;           //!
+    mutable Double_t fSkewXY = 0;            //!
+    mutable Double_t fSkewZ = 0;             //!
+    mutable Double_t fHitsLength = 0;        //! Path length following the hits order
+    mutable Bool_t fMomentsUpdated = false;  //!
+
+    mutable Double_t fMaximumDistance2 = 0;           //! Filled on demand by GetMaximumDistance2
+    mutable Bool_t fMaximumDistance2Updated = false;  //!
+
    public:
+    enum HitsTypeFlag {
+        kHitsXY = 1 << 0,
+        kHitsXZ = 1 << 1,
+        kHitsYZ = 1 << 2,
+        kHitsXYZ = 1 << 3,
+        kHitsAll = kHitsXY | kHitsXZ | kHitsYZ | kHitsXYZ
+    };
+
     void Initialize();
 
     // Setters
     void SetTrackID(Int_t sID) { fTrackID = sID; }
     void SetParentID(Int_t pID) { fParentID = pID; }
 
-    void SetVolumeHits(TRestVolumeHits hits);
+    void SetVolumeHits(const TRestVolumeHits& hits);
+    void SetVolumeHits(TRestVolumeHits&& hits);
     void RemoveVolumeHits();
 
-    Bool_t isXY() { return (&fVolumeHits)->areXY(); }
-    Bool_t isXZ() { return (&fVolumeHits)->areXZ(); }
-    Bool_t isYZ() { return (&fVolumeHits)->areYZ(); }
-    Bool_t isXYZ() { return (&fVolumeHits)->areXYZ(); }
+    void UpdateHitsType() const;
+    UChar_t GetHitsType() const {
+        if (!fHitsTypeUpdated) UpdateHitsType();
+        return fHitsType;
+    }
+
+    Bool_t isXY() const { return GetHitsType() & kHitsXY; }
+    Bool_t isXZ() const { return GetHitsType() & kHitsXZ; }
+    Bool_t isYZ() const { return GetHitsType() & kHitsYZ; }
+    Bool_t isXYZ() const { return GetHitsType() & kHitsXYZ; }
 
     // Getters
     inline Int_t GetTrackID() const { return fTrackID; }
@@ -58,26 +92,77 @@ class TRestTrack {
 
     Double_t GetLength(Bool_t update = true) { return GetTrackLength(update); }
     Double_t GetTrackLength(Bool_t update = true) {
-        if (update) fTrackLength = fVolumeHits.GetTotalDistance();
+        if (update) {
+            if (!fMomentsUpdated) UpdateMoments();
+            fTrackLength = fHitsLength;
+        }
         return fTrackLength;
     }
 
-    inline Double_t GetMaximumDistance() const { return fVolumeHits.GetMaximumHitDistance(); }
-    inline Double_t GetMaximumDistance2() const { return fVolumeHits.GetMaximumHitDistance2(); }
-    inline Double_t GetVolume() const { return fVolumeHits.GetMaximumHitDistance2(); }
+    void UpdateMoments() const;
+    void InvalidateCaches() {
+        fMomentsUpdated = false;
+        fMaximumDistance2Updated = false;
+    }
+    Double_t GetMaximumHitsDistance2() const;
+
+    inline Double_t GetMaximumDistance() const { return TMath::Sqrt(GetMaximumDistance2()); }
+    inline Double_t GetMaximumDistance2() const {
+        if (!fMaximumDistance2Updated) {
+            fMaximumDistance2 = GetMaximumHitsDistance2();
+            fMaximumDistance2Updated = true;
+        }
+        return fMaximumDistance2;
+    }
+    inline Double_t GetVolume() const { return GetMaximumDistance2(); }
 
-    inline TVector3 GetMeanPosition() const { return fVolumeHits.GetMeanPosition(); }
+    inline TVector3 GetMeanPosition() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fMeanPosition;
+    }
+    Double_t GetSigmaX() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fSigmaX;
+    }
+    Double_t GetSigmaY() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fSigmaY;
+    }
+    Double_t GetSigmaZ2() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fSigmaZ2;
+    }
+    Double_t GetSkewXY() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fSkewXY;
+    }
+    Double_t GetSkewZ() const {
+        if (!fMomentsUpdated) UpdateMoments();
+        return fSkewZ;
+    }
+    void GetBoundingBox(TVector3& min, TVector3& max) const {
+        if (!fMomentsUpdated) UpdateMoments();
+        min = fBoundingBoxMin;
+        max = fBoundingBoxMax;
+    }
 
     TRestVolumeHits* GetVolumeHits() { return &fVolumeHits; }
     TRestHits* GetHits() { return (TRestHits*)&fVolumeHits; }
     inline Int_t GetNumberOfHits() { return GetVolumeHits()->GetNumberOfHits(); }
 
+    size_t GetHitsMemoryFootprint() const;
+    size_t GetMemoryFootprint() const;
+
     void PrintTrack(Bool_t fullInfo = true);
 
     void GetBoundaries(TVector3& orig, TVector3& end);
 
     // Constructor
     TRestTrack();
+    TRestTrack(const TRestTrack&) = default;
+    TRestTrack(TRestTrack&&) = default;
+    TRestTrack& operator=(const TRestTrack&) = default;
+    TRestTrack& operator=(TRestTrack&&) = default;
     // Destructor
     ~TRestTrack();
 
@@ -39,6 +39,8 @@ class TRestTrack2DAnalysisProcess : public TRestEventProcess {
     void LoadDefaultConfig();
 
    protected:
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fTrackEvent; }
     RESTValue GetOutputEvent() const override { return fTrackEvent; }
@@ -65,7 +67,7 @@ class TRestTrack2DAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrack2DAnalysisProcess();
 
-    ClassDefOverride(TRestTrack2DAnalysisProcess, 1);  // Template for a REST "event process" class inherited
+    ClassDefOverride(TRestTrack2DAnalysisProcess, 2);  // Template for a REST "event process" class inherited
                                                        // from TRestEventProcess
 };
 #endif
@@ -39,6 +39,8 @@ class TRestTrack3DAnalysisProcess : public TRestEventProcess {
     void LoadDefaultConfig();
 
    protected:
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fTrackEvent; }
     RESTValue GetOutputEvent() const override { return fTrackEvent; }
@@ -65,7 +67,7 @@ class TRestTrack3DAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrack3DAnalysisProcess();
 
-    ClassDefOverride(TRestTrack3DAnalysisProcess, 1);  // Template for a REST "event process" class inherited
+    ClassDefOverride(TRestTrack3DAnalysisProcess, 2);  // Template for a REST "event process" class inherited
                                                        // from TRestEventProcess
 };
 #endif
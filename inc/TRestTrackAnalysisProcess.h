@@ -138,6 +138,8 @@ class TRestTrackAnalysisProcess : public TRestEventProcess {
     TVector2 fNTracksYCut;
     Double_t fDeltaEnergy;
 
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutputTrackEvent; }
@@ -172,7 +174,7 @@ class TRestTrackAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackAnalysisProcess();
 
-    ClassDefOverride(TRestTrackAnalysisProcess, 1);  // Template for a REST "event process" class inherited
+    ClassDefOverride(TRestTrackAnalysisProcess, 2);  // Template for a REST "event process" class inherited
                                                      // from TRestEventProcess
 };
 #endif
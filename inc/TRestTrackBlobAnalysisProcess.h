@@ -94,6 +94,7 @@ class TRestTrackBlobAnalysisProcess : public TRestEventProcess {
 
    protected:
     // add here the members of your event process
+    Bool_t fMemoryFootprint = false;
 
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
@@ -121,7 +122,7 @@ class TRestTrackBlobAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackBlobAnalysisProcess();
 
-    ClassDefOverride(TRestTrackBlobAnalysisProcess, 1);  // Template for a REST "event process" class
+    ClassDefOverride(TRestTrackBlobAnalysisProcess, 2);  // Template for a REST "event process" class
                                                          // inherited from TRestEventProcess
 };
 #endif
@@ -33,7 +33,11 @@ class TRestTrackDetachIsolatedNodesProcess : public TRestEventProcess {
     Double_t fTubeLengthReduction;
     Double_t fTubeRadius;
 
+    Int_t fTrackThreads = 1;  // Threads processing the top level tracks of an event, one per core if 0
+
    protected:
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutputTrackEvent; }
@@ -59,6 +63,6 @@ class TRestTrackDetachIsolatedNodesProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackDetachIsolatedNodesProcess();
 
-    ClassDefOverride(TRestTrackDetachIsolatedNodesProcess, 1);
+    ClassDefOverride(TRestTrackDetachIsolatedNodesProcess, 3);
 };
 #endif
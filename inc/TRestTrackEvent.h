@@ -22,6 +22,7 @@
 #include <TAxis.h>
 #include <TGraph.h>
 #include <TGraph2D.h>
+#include <TH1F.h>
 #include <TH2F.h>
 #include <TLegend.h>
 #include <TMultiGraph.h>
@@ -30,9 +31,27 @@
 #include <TRestTrack.h>
 #include <TVirtualPad.h>
 
+#include <functional>
 #include <iostream>
+#include <unordered_map>
+
+class TRestEventProcess;
 
 class TRestTrackEvent : public TRestEvent {
+   public:
+    /// Memory taken by the event in bytes, as given by GetMemoryFootprint
+    struct MemoryFootprint {
+        size_t fHits = 0;     // Hit columns of the tracks
+        size_t fTracks = 0;   // Track objects and the bookkeeping of their hierarchy
+        size_t fDrawing = 0;  // Graphs and histograms kept by DrawEvent and DrawHits
+
+        size_t GetTotal() const { return fHits + fTracks + fDrawing; }
+    };
+
+    /// Function solving the track at position tck of another event, given to EmplaceSolvedTracks.
+    /// It fills the hits of the tracks to add for it, and returns false if the event is not OK.
+    typedef std::function<Bool_t(Int_t tck, std::vector<TRestVolumeHits>& tracks)> TrackSolver;
+
    protected:
     Int_t fNtracks;
     Int_t fNtracksX;
@@ -43,23 +62,48 @@ class TRestTrackEvent : public TRestEvent {
 #ifndef __CINT__
     // TODO These graphs should be placed in TRestTrack?
     // (following GetGraph implementation in TRestDetectorSignal)
-    TGraph* fXYHit;       //!
-    TGraph* fXZHit;       //!
-    TGraph* fYZHit;       //!
-    TGraph2D* fXYZHit;    //!
-    TGraph* fXYTrack;     //!
-    TGraph* fXZTrack;     //!
-    TGraph* fYZTrack;     //!
-    TGraph2D* fXYZTrack;  //!
+    // Graphs owned by the event and reused by DrawEvent, one per track and projection
+    std::vector<TGraph*> fXYHit;       //!
+    std::vector<TGraph*> fXZHit;       //!
+    std::vector<TGraph*> fYZHit;       //!
+    std::vector<TGraph2D*> fXYZHit;    //!
+    std::vector<TGraph*> fXYTrack;     //!
+    std::vector<TGraph*> fXZTrack;     //!
+    std::vector<TGraph*> fYZTrack;     //!
+    std::vector<TGraph2D*> fXYZTrack;  //!
 
     TH2F* fXZHits = nullptr;  //!
     TH2F* fYZHits = nullptr;  //!
 
     TPad* fHitsPad = nullptr;  //!
 
-    Bool_t fPrintHitsWarning;  //!
+    std::unordered_map<Int_t, Int_t> fTrackIndex;     //! Track ID to position in fTrack
+    std::vector<Int_t> fTrackLevel;                   //! Level of each track in fTrack
+    std::vector<Int_t> fTopLevelTracks;               //! Positions in fTrack of the top level tracks
+    std::vector<Int_t> fTrackOrigin;                  //! Position of the origin track of each track
+    std::vector<std::vector<Int_t> > fTrackChildren;  //! Positions of the direct children of each track
+    UChar_t fTracksType = TRestTrack::kHitsAll;       //! Projection flags shared by all the tracks
+    Bool_t fLevelsUpdated = false;                    //!
+
+    ULong64_t fMutationCount = 1;  //! Incremented every time the tracks or their hierarchy change
+
+    Double_t fTopLevelEnergy[4] = {};    //! Top level energy for all, X (XZ+XYZ), Y (YZ+XYZ) and XYZ
+    Int_t fTopLevelTracksCount[3] = {};  //! Number of top level XZ, YZ and XYZ tracks
+    Int_t fTotalHits = 0;                //! Number of hits of all the tracks
+    ULong64_t fSummaryMutation = 0;      //! Value of fMutationCount for the summary above
+
+    std::vector<std::vector<Int_t> > fMaxEnergyTracks;  //! Most energetic top level tracks for XZ, YZ, XYZ
+    ULong64_t fMaxEnergyTracksMutation = 0;            //! Value of fMutationCount for fMaxEnergyTracks
+    Int_t fMaxEnergyTracksDepth = 0;                   //! Number of tracks kept for each projection
 #endif
 
+    void RegisterLastTrack();
+    void RebuildTrackIndex();
+    Int_t GetTrackIndexById(Int_t id);
+    void UpdateLevels();
+    void UpdateMaxEnergyTracks(Int_t k);
+    void UpdateSummary();
+
    public:
     TRestTrack* GetTrack(Int_t n) {
         if (n >= 0 && fTrack.size() < (unsigned int)n + 1) {
@@ -77,11 +121,15 @@ class TRestTrackEvent : public TRestEvent {
     TRestTrack* GetOriginTrackById(Int_t tckId);
     TRestTrack* GetOriginTrack(Int_t tck);
 
+    const std::vector<Int_t>& GetChildren(Int_t tck);
+    std::vector<Int_t> GetDescendants(Int_t tckId);
+
     TRestTrack* GetMaxEnergyTrackInX();
     TRestTrack* GetMaxEnergyTrackInY();
 
     TRestTrack* GetMaxEnergyTrack(TString option = "");
     TRestTrack* GetSecondMaxEnergyTrack(TString option = "");
+    std::vector<TRestTrack*> GetMaxEnergyTracks(TString option = "", Int_t k = 2);
 
     Double_t GetMaxEnergyTrackVolume(TString option = "");
     Double_t GetMaxEnergyTrackLength(TString option = "");
@@ -89,7 +137,15 @@ class TRestTrackEvent : public TRestEvent {
 
     Int_t GetLevel(Int_t tck);
     void SetLevels();
-    inline Int_t GetLevels() const { return fLevels; }
+    Int_t GetLevels() {
+        UpdateLevels();
+        return fLevels;
+    }
+    const std::vector<Int_t>& GetTopLevelTracks();
+
+    MemoryFootprint GetMemoryFootprint() const;
+    static void SetMemoryFootprintObservables(TRestEventProcess* process, const TRestTrackEvent* input,
+                                              const TRestTrackEvent* output);
 
     TPad* DrawEvent(const TString& option = "");
 
@@ -99,9 +155,15 @@ class TRestTrackEvent : public TRestEvent {
 
     // Setters
     void AddTrack(TRestTrack* c);
+    void AddTrack(TRestTrack&& c);
+    void AddTracks(TRestTrackEvent* event);
+    TRestTrack* EmplaceTrack(Int_t trackId, Int_t parentId, TRestVolumeHits&& hits);
+    Bool_t EmplaceSolvedTracks(TRestTrackEvent* input, const std::vector<Int_t>& tracks,
+                               const TrackSolver& solve, Int_t nThreads = 1);
     void RemoveTrack(int n);
+    Int_t RemoveTracksIf(const std::function<Bool_t(TRestTrack&)>& predicate);
 
-    void RemoveTracks() { fTrack.clear(); }
+    void RemoveTracks();
 
     Bool_t isXYZ();
     Bool_t isTopLevel(Int_t tck);
@@ -109,10 +171,14 @@ class TRestTrackEvent : public TRestEvent {
     Int_t GetOriginTrackID(Int_t tck);
 
     Double_t GetMaxTrackRelativeZ();
+    Double_t GetMaxTrackRelativeZ(std::vector<std::pair<Double_t, Double_t> >& zEn);
+    static Double_t GetWeightedQuantile(std::vector<std::pair<Double_t, Double_t> >& values,
+                                        Double_t fraction);
     void GetMaxTrackBoundaries(TVector3& orig, TVector3& end);
     void GetOriginEnd(std::vector<TGraph*>& originGr, std::vector<TGraph*>& endGr,
                       std::vector<TLegend*>& leg);
     TRestVolumeHits GetMaxTrackBoundaries3D(TVector3& orig, TVector3& end);
+    Bool_t GetMaxTrackBoundaries3D(TVector3& orig, TVector3& end, TRestVolumeHits* hits3D);
     void DrawOriginEnd(TPad* pad, std::vector<TGraph*>& originGr, std::vector<TGraph*>& endGr,
                        std::vector<TLegend*>& leg);
 
@@ -125,6 +191,7 @@ class TRestTrackEvent : public TRestEvent {
     Int_t GetTotalHits();
 
     void Initialize();
+    void InitializeReferences(TRestRun* run) override;
 
     void PrintOnlyTracks();
     void PrintEvent(Bool_t fullInfo = false);
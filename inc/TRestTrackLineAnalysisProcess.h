@@ -38,9 +38,14 @@ class TRestTrackLineAnalysisProcess : public TRestEventProcess {
 
     std::string fLineAnaMethod = "default";  //<
 
+    /// Z and energy of the hits, kept to avoid allocating them for each event
+    std::vector<std::pair<Double_t, Double_t> > fZEnergy;  //!
+
     void Initialize() override;
 
    protected:
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutTrackEvent; }
@@ -62,6 +67,6 @@ class TRestTrackLineAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackLineAnalysisProcess();
 
-    ClassDefOverride(TRestTrackLineAnalysisProcess, 2);
+    ClassDefOverride(TRestTrackLineAnalysisProcess, 3);
 };
 #endif
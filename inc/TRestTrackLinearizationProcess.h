@@ -39,6 +39,10 @@ class TRestTrackLinearizationProcess : public TRestEventProcess {
     // A parameter which defines the maximum number of nodes for the track linearization
     Int_t fMaxNodes = 6;
 
+    Int_t fTrackThreads = 1;  // Threads linearizing the tracks of an event, one per core if 0
+
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutTrackEvent; }
@@ -50,6 +54,7 @@ class TRestTrackLinearizationProcess : public TRestEventProcess {
     void PrintMetadata() override {
         BeginPrintProcess();
         RESTMetadata << "Max nodes: " << fMaxNodes << RESTendl;
+        RESTMetadata << "Track threads: " << fTrackThreads << RESTendl;
         EndPrintProcess();
     }
 
@@ -65,6 +70,6 @@ class TRestTrackLinearizationProcess : public TRestEventProcess {
 
     // ROOT class definition helper. Increase the number in it every time
     // you add/rename/remove the process parameters
-    ClassDefOverride(TRestTrackLinearizationProcess, 1);
+    ClassDefOverride(TRestTrackLinearizationProcess, 3);
 };
 #endif
@@ -29,10 +29,21 @@ class TRestTrackPathMinimizationProcess : public TRestEventProcess {
    protected:
     Bool_t fWeightHits = false;
 
-    TString fMinMethod = "default";  // Minimization method, default is HeldKarp
+    // Minimization method: default (HeldKarp), bruteforce, closestN, linkern or dp
+    TString fMinMethod = "default";
+    Int_t fMaxDPNodes = 16;  // Tracks with more hits fall back to HeldKarp with the dp method
+    Int_t fMaxStarts = 10;   // Number of starting hits tried by the closestN method
+
+    Int_t fMaxHeldKarpNodes = 1000000;  // Branch and bound nodes allowed to HeldKarp for each track
+    Double_t fTrackTimeBudget = -1;     // Seconds allowed to HeldKarp for each track, none if negative
+    Double_t fEventTimeBudget = -1;     // Seconds allowed to HeldKarp for each event, none if negative
+
+    Int_t fTrackThreads = 1;  // Threads minimizing the top level tracks of an event, one per core if 0
     Bool_t fCyclic = false;  // In case you want to find the minimum path using a cyclic loop (e.g. first hit
                              // is connected to last hit)
 
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutputTrackEvent; }
@@ -41,7 +52,9 @@ class TRestTrackPathMinimizationProcess : public TRestEventProcess {
     TRestEvent* ProcessEvent(TRestEvent* inputEvent) override;
     void BruteForce(TRestVolumeHits* hits, std::vector<int>& bestPath);
     void NearestNeighbour(TRestVolumeHits* hits, std::vector<int>& bestPath);
-    void HeldKarp(TRestVolumeHits* hits, std::vector<int>& bestPath);
+    void LocalSearch(TRestVolumeHits* hits, std::vector<int>& bestPath);
+    void DynamicProgramming(TRestVolumeHits* hits, std::vector<int>& bestPath);
+    Int_t HeldKarp(TRestVolumeHits* hits, std::vector<int>& bestPath, Double_t timeBudget = -1);
     void EndProcess() override;
 
     void PrintMetadata() override {
@@ -56,6 +69,14 @@ class TRestTrackPathMinimizationProcess : public TRestEventProcess {
             RESTMetadata << "Weight hits : disabled" << RESTendl;
 
         RESTMetadata << "Minimization method " << fMinMethod << RESTendl;
+        if (fMinMethod == "closestN") RESTMetadata << "Maximum number of starts " << fMaxStarts << RESTendl;
+        if (fMinMethod == "dp") RESTMetadata << "Maximum number of dp nodes " << fMaxDPNodes << RESTendl;
+        RESTMetadata << "HeldKarp nodes per track " << fMaxHeldKarpNodes << RESTendl;
+        RESTMetadata << "Track threads " << fTrackThreads << RESTendl;
+        if (fTrackTimeBudget >= 0)
+            RESTMetadata << "HeldKarp time per track " << fTrackTimeBudget << " s" << RESTendl;
+        if (fEventTimeBudget >= 0)
+            RESTMetadata << "HeldKarp time per event " << fEventTimeBudget << " s" << RESTendl;
         EndPrintProcess();
     }
 
@@ -66,6 +87,6 @@ class TRestTrackPathMinimizationProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackPathMinimizationProcess();
 
-    ClassDefOverride(TRestTrackPathMinimizationProcess, 2);
+    ClassDefOverride(TRestTrackPathMinimizationProcess, 7);
 };
 #endif
@@ -32,6 +32,7 @@ class TRestTrackPointLikeAnalysisProcess : public TRestEventProcess {
 
    protected:
     // add here the members of your event process
+    Bool_t fMemoryFootprint = false;
 
    public:
     RESTValue GetInputEvent() const override { return fTrackEvent; }
@@ -60,7 +61,7 @@ class TRestTrackPointLikeAnalysisProcess : public TRestEventProcess {
     ~TRestTrackPointLikeAnalysisProcess();
 
     ClassDefOverride(TRestTrackPointLikeAnalysisProcess,
-                     1);  // Template for a REST "event process" class inherited from
+                     2);  // Template for a REST "event process" class inherited from
                           // TRestEventProcess
 };
 #endif
@@ -21,13 +21,11 @@ class TRestTrackReconnectionProcess : public TRestEventProcess {
 #ifndef __CINT__
     TRestTrackEvent* fInputTrackEvent;   //!
     TRestTrackEvent* fOutputTrackEvent;  //!
-
-    Double_t fMeanDistance;  //!
-    Double_t fSigma;         //!
 #endif
 
     Bool_t fSplitTrack;
     Double_t fNSigmas;
+    Int_t fTrackThreads = 1;  // Threads reconnecting the top level tracks of an event, one per core if 0
 
     void InitFromConfigFile() override;
 
@@ -36,6 +34,8 @@ class TRestTrackReconnectionProcess : public TRestEventProcess {
     void SetDistanceMeanAndSigma(TRestHits* h);
 
    protected:
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutputTrackEvent; }
@@ -57,6 +57,7 @@ class TRestTrackReconnectionProcess : public TRestEventProcess {
             RESTMetadata << " disabled" << RESTendl;
 
         RESTMetadata << "Number of sigmas to defined a branch : " << fNSigmas << RESTendl;
+        RESTMetadata << "Track threads : " << fTrackThreads << RESTendl;
 
         EndPrintProcess();
     }
@@ -73,6 +74,6 @@ class TRestTrackReconnectionProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackReconnectionProcess();
 
-    ClassDefOverride(TRestTrackReconnectionProcess, 1);
+    ClassDefOverride(TRestTrackReconnectionProcess, 3);
 };
 #endif
@@ -33,6 +33,10 @@ class TRestTrackReductionProcess : public TRestEventProcess {
     Int_t fMaxIt = 100;
     Bool_t fKmeans = false;
 
+    Int_t fTrackThreads = 1;  // Threads reducing the top level tracks of an event, one per core if 0
+
+    Bool_t fMemoryFootprint = false;
+
    public:
     RESTValue GetInputEvent() const override { return fInputTrackEvent; }
     RESTValue GetOutputEvent() const override { return fOutputTrackEvent; }
@@ -51,6 +55,7 @@ class TRestTrackReductionProcess : public TRestEventProcess {
         RESTMetadata << " Maximum number of nodes : " << fMaxNodes << RESTendl;
         RESTMetadata << " Perform kMeans clustering : " << fKmeans << RESTendl;
         if (fKmeans) RESTMetadata << " Maximum iterations : " << fMaxIt << RESTendl;
+        RESTMetadata << " Track threads : " << fTrackThreads << RESTendl;
 
         EndPrintProcess();
     }
@@ -62,7 +67,7 @@ class TRestTrackReductionProcess : public TRestEventProcess {
     // Destructor
     ~TRestTrackReductionProcess();
 
-    ClassDefOverride(TRestTrackReductionProcess, 2);  // Template for a REST "event process" class inherited
+    ClassDefOverride(TRestTrackReductionProcess, 4);  // Template for a REST "event process" class inherited
                                                       // from TRestEventProcess
 };
 #endif
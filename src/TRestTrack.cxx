@@ -18,10 +18,111 @@
 
 #include "TRestTrack.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
 using namespace std;
 
 ClassImp(TRestTrack);
 
+namespace {
+typedef std::pair<Double_t, Double_t> Point2D;
+
+Double_t Cross(const Point2D& o, const Point2D& a, const Point2D& b) {
+    return (a.first - o.first) * (b.second - o.second) - (a.second - o.second) * (b.first - o.first);
+}
+
+Double_t Distance2(const Point2D& a, const Point2D& b) {
+    const Double_t d1 = a.first - b.first;
+    const Double_t d2 = a.second - b.second;
+    return d1 * d1 + d2 * d2;
+}
+
+///////////////////////////////////////////////
+/// It returns the maximum squared distance between two of the points given. The
+/// convex hull is built with the monotone chain algorithm, and its diameter is
+/// found by rotating calipers, which is O(n log n) instead of comparing all pairs.
+///
+Double_t GetMaximumDistance2D(std::vector<Point2D>& points) {
+    const size_t n = points.size();
+    if (n < 2) return 0;
+
+    std::sort(points.begin(), points.end());
+
+    std::vector<Point2D> hull(2 * n);
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        while (k >= 2 && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+        hull[k++] = points[i];
+    }
+    for (size_t i = n - 1, lower = k + 1; i > 0; i--) {
+        while (k >= lower && Cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) k--;
+        hull[k++] = points[i - 1];
+    }
+    hull.resize(k - 1);
+
+    const size_t h = hull.size();
+    if (h < 3) return Distance2(hull.front(), hull.back());
+
+    Double_t max = 0;
+    for (size_t i = 0, j = 1; i < h; i++) {
+        const Point2D& a = hull[i];
+        const Point2D& b = hull[(i + 1) % h];
+        while (std::abs(Cross(a, b, hull[(j + 1) % h])) > std::abs(Cross(a, b, hull[j]))) j = (j + 1) % h;
+        max = std::max(max, std::max(Distance2(a, hull[j]), Distance2(b, hull[j])));
+    }
+    return max;
+}
+
+///////////////////////////////////////////////
+/// It returns the maximum squared distance between two of the 3D points given. The
+/// result is exact: a lower bound is first obtained by walking to the farthest point
+/// a few times, and then only the pairs whose distances to the centroid could still
+/// exceed it are compared. For elongated tracks this discards almost all the pairs.
+///
+Double_t GetMaximumDistance3D(const std::vector<TVector3>& points) {
+    const size_t n = points.size();
+    if (n < 2) return 0;
+
+    TVector3 centroid(0, 0, 0);
+    for (const auto& p : points) centroid += p;
+    centroid *= 1. / n;
+
+    std::vector<Double_t> radius(n);
+    for (size_t i = 0; i < n; i++) radius[i] = (points[i] - centroid).Mag();
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return radius[a] > radius[b]; });
+
+    Double_t max = 0;
+    size_t from = order[0];
+    for (int iter = 0; iter < 3; iter++) {
+        size_t farthest = from;
+        for (size_t i = 0; i < n; i++) {
+            const Double_t d2 = (points[i] - points[from]).Mag2();
+            if (d2 > max) {
+                max = d2;
+                farthest = i;
+            }
+        }
+        if (farthest == from) break;
+        from = farthest;
+    }
+
+    // Two points cannot be farther apart than the sum of their distances to the
+    // centroid. A small margin protects the pruning against rounding.
+    auto canExceed = [&](Double_t r) { return r * r * (1 + 1e-12) >= max; };
+    for (size_t i = 1; i < n && canExceed(radius[order[i]] + radius[order[0]]); i++) {
+        const TVector3& p = points[order[i]];
+        for (size_t j = 0; j < i && canExceed(radius[order[i]] + radius[order[j]]); j++)
+            max = std::max(max, (p - points[order[j]]).Mag2());
+    }
+    return max;
+}
+}  // namespace
+
 TRestTrack::TRestTrack() {
     // TRestTrack default constructor
 }
@@ -36,18 +137,142 @@ void TRestTrack::Initialize() {
     fTrackEnergy = 0;
     fTrackLength = 0;
     fVolumeHits.RemoveHits();
+    fHitsType = kHitsAll;
+    fHitsTypeUpdated = true;
+    InvalidateCaches();
 }
 
-void TRestTrack::SetVolumeHits(TRestVolumeHits hits) {
+void TRestTrack::SetVolumeHits(const TRestVolumeHits& hits) {
     fVolumeHits = hits;
-    fTrackEnergy = hits.GetTotalEnergy();
-    fTrackLength = hits.GetTotalDistance();
+    fTrackEnergy = fVolumeHits.GetTotalEnergy();
+    fTrackLength = fVolumeHits.GetTotalDistance();
+    UpdateHitsType();
+    InvalidateCaches();
+}
+
+///////////////////////////////////////////////
+/// \brief It takes over the hits given, avoiding the copy of the hit arrays when
+/// TRestVolumeHits can be moved. The hits given are left empty.
+///
+void TRestTrack::SetVolumeHits(TRestVolumeHits&& hits) {
+    fVolumeHits = std::move(hits);
+    fTrackEnergy = fVolumeHits.GetTotalEnergy();
+    fTrackLength = fVolumeHits.GetTotalDistance();
+    UpdateHitsType();
+    InvalidateCaches();
 }
 
 void TRestTrack::RemoveVolumeHits() {
     fVolumeHits.RemoveHits();
     fTrackEnergy = 0;
     fTrackLength = 0;
+    fHitsType = kHitsAll;
+    fHitsTypeUpdated = true;
+    InvalidateCaches();
+}
+
+///////////////////////////////////////////////
+/// \brief It scans the hits once and caches the projection shared by all of them,
+/// so that isXY(), isXZ(), isYZ() and isXYZ() become a flag check. As for
+/// TRestHits::areXY() and friends, all the flags are set for a track without hits.
+///
+/// It is called by SetVolumeHits, and it must be called again if the hits are
+/// modified through GetVolumeHits().
+///
+void TRestTrack::UpdateHitsType() const {
+    const int nHits = fVolumeHits.GetNumberOfHits();
+
+    fHitsType = kHitsAll;
+    if (nHits > 0) {
+        const REST_HitType type = fVolumeHits.GetType(0);
+        if (type == XY)
+            fHitsType = kHitsXY;
+        else if (type == XZ)
+            fHitsType = kHitsXZ;
+        else if (type == YZ)
+            fHitsType = kHitsYZ;
+        else if (type == XYZ)
+            fHitsType = kHitsXYZ;
+        else
+            fHitsType = 0;
+
+        for (int n = 1; n < nHits && fHitsType != 0; n++)
+            if (fVolumeHits.GetType(n) != type) fHitsType = 0;
+    }
+
+    fHitsTypeUpdated = true;
+}
+
+///////////////////////////////////////////////
+/// \brief It computes at once the quantities derived from the hits that are used
+/// by the analysis processes: the mean position, the spread and skewness, the path
+/// length and the bounding box. They are kept until the hits are replaced, so that
+/// repeated queries do not scan the hits again. The maximum distance between hits is
+/// not linear in the number of hits, so it is cached apart by GetMaximumDistance2.
+///
+/// The moments follow the definitions of TRestHits. The bounding box of each axis
+/// only considers the hits that measure that coordinate, and it is zero when there
+/// are none. InvalidateCaches() must be called if the hits are modified through
+/// GetVolumeHits().
+///
+void TRestTrack::UpdateMoments() const {
+    fMeanPosition = fVolumeHits.GetMeanPosition();
+    fSigmaX = fVolumeHits.GetSigmaX();
+    fSigmaY = fVolumeHits.GetSigmaY();
+    fSigmaZ2 = fVolumeHits.GetSigmaZ2();
+    fSkewXY = fVolumeHits.GetSkewXY();
+    fSkewZ = fVolumeHits.GetSkewZ();
+    fHitsLength = fVolumeHits.GetTotalDistance();
+
+    Double_t min[3] = {0, 0, 0};
+    Double_t max[3] = {0, 0, 0};
+    Bool_t found[3] = {false, false, false};
+    const REST_HitType axes[3] = {X, Y, Z};
+
+    for (unsigned int n = 0; n < fVolumeHits.GetNumberOfHits(); n++) {
+        const REST_HitType type = fVolumeHits.GetType(n);
+        const Double_t pos[3] = {fVolumeHits.GetX(n), fVolumeHits.GetY(n), fVolumeHits.GetZ(n)};
+        for (int i = 0; i < 3; i++) {
+            if (type % axes[i] != 0) continue;
+            if (!found[i] || pos[i] < min[i]) min[i] = pos[i];
+            if (!found[i] || pos[i] > max[i]) max[i] = pos[i];
+            found[i] = true;
+        }
+    }
+    fBoundingBoxMin.SetXYZ(min[0], min[1], min[2]);
+    fBoundingBoxMax.SetXYZ(max[0], max[1], max[2]);
+
+    fMomentsUpdated = true;
+}
+
+///////////////////////////////////////////////
+/// \brief It returns the maximum squared distance between two hits of the track, as
+/// TRestHits::GetMaximumHitDistance2 does, without comparing every pair of hits.
+///
+/// For XY, XZ and YZ tracks the diameter of the 2D convex hull of the hits is exact
+/// and O(n log n). For XYZ tracks an exact search with pruning is used. Tracks
+/// mixing hit types use the pairwise comparison of TRestHits.
+///
+Double_t TRestTrack::GetMaximumHitsDistance2() const {
+    const unsigned int nHits = fVolumeHits.GetNumberOfHits();
+    if (nHits < 2) return 0;
+
+    const UChar_t type = GetHitsType();
+    if (type == kHitsXYZ) {
+        std::vector<TVector3> points(nHits);
+        for (unsigned int n = 0; n < nHits; n++) points[n] = fVolumeHits.GetPosition(n);
+        return GetMaximumDistance3D(points);
+    }
+
+    if (type != kHitsXY && type != kHitsXZ && type != kHitsYZ) return fVolumeHits.GetMaximumHitDistance2();
+
+    std::vector<Point2D> points(nHits);
+    for (unsigned int n = 0; n < nHits; n++) {
+        const Double_t first = type == kHitsYZ ? fVolumeHits.GetY(n) : fVolumeHits.GetX(n);
+        const Double_t second = type == kHitsXY ? fVolumeHits.GetY(n) : fVolumeHits.GetZ(n);
+        points[n] = Point2D(first, second);
+    }
+    return GetMaximumDistance2D(points);
 }
 
 ///////////////////////////////////////////////
@@ -87,6 +312,23 @@ void TRestTrack::GetBoundaries(TVector3& orig, TVector3& end) {
     }
 }
 
+///////////////////////////////////////////////
+/// \brief It returns the memory in bytes taken by the hit columns of the track,
+/// the position, time, energy, type and size of each hit.
+///
+/// The hits of TRestVolumeHits are not accessible as containers, so it is computed
+/// from the number of hits, and the memory reserved beyond them is not included.
+///
+size_t TRestTrack::GetHitsMemoryFootprint() const {
+    const size_t hitSize = 8 * sizeof(Float_t) + sizeof(REST_HitType);
+    return fVolumeHits.GetNumberOfHits() * hitSize;
+}
+
+///////////////////////////////////////////////
+/// \brief It returns the memory in bytes taken by the track, including its hits.
+///
+size_t TRestTrack::GetMemoryFootprint() const { return sizeof(TRestTrack) + GetHitsMemoryFootprint(); }
+
 void TRestTrack::PrintTrack(Bool_t fullInfo) {
     Double_t x = GetMeanPosition().X();
     Double_t y = GetMeanPosition().Y();
@@ -217,15 +217,15 @@ TRestEvent* TRestTrack2DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
         if (t->isXZ()) {
             XZ_NHitsX[t->GetTrackID()] = t->GetNumberOfHits();
             XZ_EnergyX[t->GetTrackID()] = t->GetTrackEnergy();
-            XZ_SigmaX[t->GetTrackID()] = t->GetHits()->GetSigmaX();
-            XZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetHits()->GetSigmaZ2());
+            XZ_SigmaX[t->GetTrackID()] = t->GetSigmaX();
+            XZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetSigmaZ2());
             XZ_GaussSigmaX[t->GetTrackID()] = t->GetHits()->GetGaussSigmaX();
             XZ_GaussSigmaZ[t->GetTrackID()] = t->GetHits()->GetGaussSigmaZ();
             XZ_LengthX[t->GetTrackID()] = t->GetLength();
             XZ_VolumeX[t->GetTrackID()] = t->GetVolume();
             XZ_MeanX[t->GetTrackID()] = t->GetMeanPosition().X();
             XZ_MeanZ[t->GetTrackID()] = t->GetMeanPosition().Z();
-            XZ_SkewZ[t->GetTrackID()] = t->GetHits()->GetSkewZ();
+            XZ_SkewZ[t->GetTrackID()] = t->GetSkewZ();
 
             YZ_NHitsY[t->GetTrackID()] = 0;
             YZ_EnergyY[t->GetTrackID()] = 0;
@@ -253,15 +253,15 @@ TRestEvent* TRestTrack2DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
 
             YZ_NHitsY[t->GetTrackID()] = t->GetNumberOfHits();
             YZ_EnergyY[t->GetTrackID()] = t->GetTrackEnergy();
-            YZ_SigmaY[t->GetTrackID()] = t->GetHits()->GetSigmaY();
-            YZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetHits()->GetSigmaZ2());
+            YZ_SigmaY[t->GetTrackID()] = t->GetSigmaY();
+            YZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetSigmaZ2());
             YZ_GaussSigmaY[t->GetTrackID()] = t->GetHits()->GetGaussSigmaY();
             YZ_GaussSigmaZ[t->GetTrackID()] = t->GetHits()->GetGaussSigmaZ();
             YZ_LengthY[t->GetTrackID()] = t->GetLength();
             YZ_VolumeY[t->GetTrackID()] = t->GetVolume();
             YZ_MeanY[t->GetTrackID()] = t->GetMeanPosition().Y();
             YZ_MeanZ[t->GetTrackID()] = t->GetMeanPosition().Z();
-            YZ_SkewZ[t->GetTrackID()] = t->GetHits()->GetSkewZ();
+            YZ_SkewZ[t->GetTrackID()] = t->GetSkewZ();
         } else {
             XZ_EnergyX[t->GetTrackID()] = 0;
             XZ_SigmaX[t->GetTrackID()] = 0;
@@ -619,9 +619,13 @@ TRestEvent* TRestTrack2DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
     SetObservableValue("MaxTrack_XZ_YZ_SkewXY", MaxTrack_XZ_YZ_SkewXY);
     SetObservableValue("MaxTrack_XZ_YZ_SkewZ", MaxTrack_XZ_YZ_SkewZ);
 
+    if (fMemoryFootprint) TRestTrackEvent::SetMemoryFootprintObservables(this, fTrackEvent, fTrackEvent);
+
     return fTrackEvent;
 }
 
 void TRestTrack2DAnalysisProcess::EndProcess() {}
 
-void TRestTrack2DAnalysisProcess::InitFromConfigFile() {}
+void TRestTrack2DAnalysisProcess::InitFromConfigFile() {
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
+}
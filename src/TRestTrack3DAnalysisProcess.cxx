@@ -159,9 +159,9 @@ TRestEvent* TRestTrack3DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
         if (t->isXYZ()) {
             XYZ_NHits[t->GetTrackID()] = t->GetNumberOfHits();
             XYZ_Energy[t->GetTrackID()] = t->GetTrackEnergy();
-            XYZ_SigmaX[t->GetTrackID()] = t->GetHits()->GetSigmaX();
-            XYZ_SigmaY[t->GetTrackID()] = t->GetHits()->GetSigmaY();
-            XYZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetHits()->GetSigmaZ2());
+            XYZ_SigmaX[t->GetTrackID()] = t->GetSigmaX();
+            XYZ_SigmaY[t->GetTrackID()] = t->GetSigmaY();
+            XYZ_SigmaZ[t->GetTrackID()] = sqrt(t->GetSigmaZ2());
             XYZ_GaussSigmaX[t->GetTrackID()] = t->GetHits()->GetGaussSigmaX();
             XYZ_GaussSigmaY[t->GetTrackID()] = t->GetHits()->GetGaussSigmaY();
             XYZ_GaussSigmaZ[t->GetTrackID()] = t->GetHits()->GetGaussSigmaZ();
@@ -170,8 +170,8 @@ TRestEvent* TRestTrack3DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
             XYZ_MeanX[t->GetTrackID()] = t->GetMeanPosition().X();
             XYZ_MeanY[t->GetTrackID()] = t->GetMeanPosition().Y();
             XYZ_MeanZ[t->GetTrackID()] = t->GetMeanPosition().Z();
-            XYZ_SkewXY[t->GetTrackID()] = t->GetHits()->GetSkewXY();
-            XYZ_SkewZ[t->GetTrackID()] = t->GetHits()->GetSkewZ();
+            XYZ_SkewXY[t->GetTrackID()] = t->GetSkewXY();
+            XYZ_SkewZ[t->GetTrackID()] = t->GetSkewZ();
         } else {
             XYZ_NHits[t->GetTrackID()] = 0;
             XYZ_Energy[t->GetTrackID()] = 0;
@@ -301,9 +301,13 @@ TRestEvent* TRestTrack3DAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
     // --- Distance observables between first two tracks --- //
     SetObservableValue("XYZ_FirstSecondTracksDistance", XYZ_FirstSecondTracksDistance);
 
+    if (fMemoryFootprint) TRestTrackEvent::SetMemoryFootprintObservables(this, fTrackEvent, fTrackEvent);
+
     return fTrackEvent;
 }
 
 void TRestTrack3DAnalysisProcess::EndProcess() {}
 
-void TRestTrack3DAnalysisProcess::InitFromConfigFile() {}
+void TRestTrack3DAnalysisProcess::InitFromConfigFile() {
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
+}
@@ -185,8 +185,7 @@ TRestEvent* TRestTrackBlobAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     fInputTrackEvent = (TRestTrackEvent*)inputEvent;
 
     // Copying the input tracks to the output track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++)
-        fOutputTrackEvent->AddTrack(fInputTrackEvent->GetTrack(tck));
+    fOutputTrackEvent->AddTracks(fInputTrackEvent);
 
     vector<TRestTrack*> tracks;
 
@@ -472,6 +471,9 @@ TRestEvent* TRestTrackBlobAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
         }
     }
 
+    if (fMemoryFootprint)
+        TRestTrackEvent::SetMemoryFootprintObservables(this, fInputTrackEvent, fOutputTrackEvent);
+
     return fOutputTrackEvent;
 }
 
@@ -486,4 +488,6 @@ void TRestTrackBlobAnalysisProcess::EndProcess() {
 
 void TRestTrackBlobAnalysisProcess::InitFromConfigFile() {
     fHitsToCheckFraction = StringToDouble(GetParameter("hitsToCheckFraction", "0.2"));
+
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
 }
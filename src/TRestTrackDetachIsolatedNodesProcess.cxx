@@ -59,11 +59,9 @@ TRestEvent* TRestTrackDetachIsolatedNodesProcess::ProcessEvent(TRestEvent* input
         fInputTrackEvent->PrintEvent();
 
     // Copying the input tracks to the output track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++)
-        fOutputTrackEvent->AddTrack(fInputTrackEvent->GetTrack(tck));
+    fOutputTrackEvent->AddTracks(fInputTrackEvent);
 
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++) {
-        if (!fInputTrackEvent->isTopLevel(tck)) continue;
+    auto solve = [&](Int_t tck, std::vector<TRestVolumeHits>& tracks) {
         Int_t tckId = fInputTrackEvent->GetTrack(tck)->GetTrackID();
 
         TRestVolumeHits* hits = fInputTrackEvent->GetTrack(tck)->GetVolumeHits();
@@ -114,14 +112,7 @@ TRestEvent* TRestTrackDetachIsolatedNodesProcess::ProcessEvent(TRestEvent* input
                 isolatedHit.AddHit(hits->GetPosition(n), hits->GetEnergy(n), 0, hits->GetType(n),
                                    hits->GetSigma(n));
 
-                TRestTrack isoTrack;
-                isoTrack.SetTrackID(fOutputTrackEvent->GetNumberOfTracks() + 1);
-
-                isoTrack.SetParentID(tckId);
-
-                isoTrack.SetVolumeHits(isolatedHit);
-
-                fOutputTrackEvent->AddTrack(&isoTrack);
+                tracks.emplace_back(std::move(isolatedHit));
 
                 isolatedHit.RemoveHits();
             } else {
@@ -133,15 +124,14 @@ TRestEvent* TRestTrackDetachIsolatedNodesProcess::ProcessEvent(TRestEvent* input
         connectedHits.AddHit(hits->GetPosition(nHits - 1), hits->GetEnergy(nHits - 1), 0,
                              hits->GetType(nHits - 1), hits->GetSigma(nHits - 1));
 
-        TRestTrack connectedTrack;
-        connectedTrack.SetTrackID(fOutputTrackEvent->GetNumberOfTracks() + 1);
+        tracks.emplace_back(std::move(connectedHits));
+        return true;
+    };
 
-        connectedTrack.SetParentID(tckId);
-
-        connectedTrack.SetVolumeHits(connectedHits);
-
-        fOutputTrackEvent->AddTrack(&connectedTrack);
-    }
+    const Int_t nThreads =
+        GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug ? 1 : fTrackThreads;
+    fOutputTrackEvent->EmplaceSolvedTracks(fInputTrackEvent, fInputTrackEvent->GetTopLevelTracks(), solve,
+                                           nThreads);
 
     if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
         cout << "xxxx DetachIsolatedNodes trackEvent output xxxxx" << endl;
@@ -150,6 +140,9 @@ TRestEvent* TRestTrackDetachIsolatedNodesProcess::ProcessEvent(TRestEvent* input
         GetChar();
     }
 
+    if (fMemoryFootprint)
+        TRestTrackEvent::SetMemoryFootprintObservables(this, fInputTrackEvent, fOutputTrackEvent);
+
     return fOutputTrackEvent;
 }
 
@@ -161,4 +154,8 @@ void TRestTrackDetachIsolatedNodesProcess::InitFromConfigFile() {
 
     fTubeLengthReduction = StringToDouble(GetParameter("tubeLength", "0.2"));
     fTubeRadius = StringToDouble(GetParameter("tubeRadius", "0.2"));
+
+    fTrackThreads = StringToInteger(GetParameter("trackThreads", "1"));
+
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
 }
@@ -20,297 +20,753 @@
 
 #include "TRestTrackEvent.h"
 
+#include <TROOT.h>
+
+#include "TRestEventProcess.h"
 #include "TRestRun.h"
 #include "TRestTools.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
 using namespace std;
 
 ClassImp(TRestTrackEvent);
 
+namespace {
+// Projections used to rank the tracks by energy: "X" -> XZ, "Y" -> YZ, anything else -> XYZ
+enum { kRankXZ = 0, kRankYZ = 1, kRankXYZ = 2 };
+const UChar_t kRankFlags[3] = {TRestTrack::kHitsXZ, TRestTrack::kHitsYZ, TRestTrack::kHitsXYZ};
+
+Int_t GetRankProjection(const TString& option) {
+    if (option == "X") return kRankXZ;
+    if (option == "Y") return kRankYZ;
+    return kRankXYZ;
+}
+
+// It returns the next graph of the given list for DrawEvent, creating it when all
+// of them are already in use, after removing the points of a previous drawing
+template <class T>
+T* GetDrawingGraph(std::vector<T*>& graphs, size_t& used) {
+    if (used == graphs.size()) graphs.push_back(new T());
+    T* graph = graphs[used++];
+    graph->Set(0);
+    return graph;
+}
+
+// It adds a hit to the marker graph gr, taking it from graphs if it does not exist yet
+void AddDrawingHit(TGraph*& gr, std::vector<TGraph*>& graphs, size_t& used, Int_t color, Double_t size,
+                   Double_t x, Double_t y) {
+    if (gr == nullptr) {
+        gr = GetDrawingGraph(graphs, used);
+        gr->SetMarkerColor(color);
+        gr->SetMarkerSize(size);
+        gr->SetMarkerStyle(20);
+    }
+    gr->SetPoint(gr->GetN(), x, y);
+}
+
+void SetDrawingFrameStyle(TH1F* frame, const char* xTitle, const char* yTitle) {
+    if (frame == nullptr) return;
+    frame->GetXaxis()->SetTitle(xTitle);
+    frame->GetYaxis()->SetTitle(yTitle);
+    frame->GetYaxis()->SetTitleOffset(1.75);
+    frame->GetYaxis()->SetTitleSize(1.4 * frame->GetYaxis()->GetTitleSize());
+    frame->GetXaxis()->SetTitleSize(1.4 * frame->GetXaxis()->GetTitleSize());
+    frame->GetYaxis()->SetLabelSize(1.25 * frame->GetYaxis()->GetLabelSize());
+    frame->GetXaxis()->SetLabelSize(1.25 * frame->GetXaxis()->GetLabelSize());
+}
+}  // namespace
+
 TRestTrackEvent::TRestTrackEvent() {
     // TRestTrackEvent default constructor
     TRestEvent::Initialize();
     fTrack.clear();
-    fXYHit = nullptr;
-    fXZHit = nullptr;
-    fYZHit = nullptr;
-    fXYZHit = nullptr;
-    fXYTrack = nullptr;
-    fXZTrack = nullptr;
-    fYZTrack = nullptr;
-    fXYZTrack = nullptr;
     fPad = nullptr;
     fLevels = -1;
-
-    fPrintHitsWarning = true;
 }
 
 TRestTrackEvent::~TRestTrackEvent() {
     // TRestTrackEvent destructor
+    for (auto graphs : {&fXYHit, &fXZHit, &fYZHit, &fXYTrack, &fXZTrack, &fYZTrack})
+        for (auto gr : *graphs) delete gr;
+    for (auto gr : fXYZHit) delete gr;
+    for (auto gr : fXYZTrack) delete gr;
 }
 
 void TRestTrackEvent::Initialize() {
+    fMutationCount++;
     fNtracks = 0;
     fNtracksX = 0;
     fNtracksY = 0;
     fTrack.clear();
+    fTrackIndex.clear();
+    fTrackLevel.clear();
+    fTopLevelTracks.clear();
+    fTrackOrigin.clear();
+    fTrackChildren.clear();
+    fTracksType = TRestTrack::kHitsAll;
+    fLevels = 0;
+    fLevelsUpdated = true;
     TRestEvent::Initialize();
 }
 
+///////////////////////////////////////////////
+/// \brief It is called after the event has been read from a file. The ID index, the
+/// track levels and the hit types are transient, so they are rebuilt here from the
+/// streamed tracks. The cached moments are dropped as well, as ROOT may read the
+/// new entry into the tracks of the previous one.
+///
+void TRestTrackEvent::InitializeReferences(TRestRun* run) {
+    TRestEvent::InitializeReferences(run);
+    for (auto& track : fTrack) {
+        track.UpdateHitsType();
+        track.InvalidateCaches();
+    }
+    RebuildTrackIndex();
+    SetLevels();
+}
+
 void TRestTrackEvent::AddTrack(TRestTrack* c) {
+    fTrack.emplace_back(*c);
+    RegisterLastTrack();
+}
+
+///////////////////////////////////////////////
+/// \brief It adds the track given, moving its content into the event instead of
+/// copying it.
+///
+void TRestTrackEvent::AddTrack(TRestTrack&& c) {
+    fTrack.emplace_back(std::move(c));
+    RegisterLastTrack();
+}
+
+///////////////////////////////////////////////
+/// \brief It builds a new track in place at the end of the event, taking over the
+/// hits given. Compared to filling a TRestTrack and calling AddTrack, it saves the
+/// intermediate track and its copy into the event.
+///
+/// It returns a pointer to the new track, which is valid until the next track is
+/// added to or removed from the event.
+///
+TRestTrack* TRestTrackEvent::EmplaceTrack(Int_t trackId, Int_t parentId, TRestVolumeHits&& hits) {
+    fTrack.emplace_back();
+    TRestTrack* track = &fTrack.back();
+    track->Initialize();
+    track->SetTrackID(trackId);
+    track->SetParentID(parentId);
+    track->SetVolumeHits(std::move(hits));
+    RegisterLastTrack();
+    return track;
+}
+
+///////////////////////////////////////////////
+/// \brief It solves the tracks of input at the given positions, and adds the
+/// tracks given by each solver call as children of the solved track. The solver
+/// calls run on up to nThreads threads, or on as many threads as cores if nThreads
+/// is 0, each thread taking the largest track left when it is done with the last
+/// one. The solver only gets to write to its own vector of hits, so it must not
+/// modify the process or the events, and it should keep any scratch memory on its
+/// stack. The new tracks are added after all the calls, in the order of the tracks
+/// given and from the calling thread, so that the track IDs do not depend on the
+/// number of threads. The thread safety of ROOT is enabled before the first threads
+/// are started.
+///
+/// It returns false if any of the solver calls returned false.
+///
+Bool_t TRestTrackEvent::EmplaceSolvedTracks(TRestTrackEvent* input, const std::vector<Int_t>& tracks,
+                                            const TrackSolver& solve, Int_t nThreads) {
+    const size_t nTracks = tracks.size();
+    std::vector<std::vector<TRestVolumeHits> > solved(nTracks);
+    std::vector<char> ok(nTracks, 1);
+
+    if (nThreads <= 0) nThreads = std::max(1u, std::thread::hardware_concurrency());
+    if ((size_t)nThreads > nTracks) nThreads = nTracks;
+
+    if (nThreads <= 1) {
+        for (size_t n = 0; n < nTracks; n++) ok[n] = solve(tracks[n], solved[n]);
+    } else {
+        // The hierarchy and the ID index are built here, as the solvers may read them
+        input->UpdateLevels();
+        input->RebuildTrackIndex();
+
+        std::vector<size_t> order(nTracks);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return input->fTrack[tracks[a]].GetNumberOfHits() > input->fTrack[tracks[b]].GetNumberOfHits();
+        });
+
+        static std::once_flag rootThreadSafety;
+        std::call_once(rootThreadSafety, []() { ROOT::EnableThreadSafety(); });
+
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::atomic_flag errorSet = ATOMIC_FLAG_INIT;
+        auto work = [&]() {
+            for (size_t k = next++; k < nTracks; k = next++) {
+                const size_t n = order[k];
+                try {
+                    ok[n] = solve(tracks[n], solved[n]);
+                } catch (...) {
+                    if (!errorSet.test_and_set()) error = std::current_exception();
+                    next = nTracks;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 1; t < nThreads; t++) threads.emplace_back(work);
+        work();
+        for (auto& thread : threads) thread.join();
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    Bool_t allOk = true;
+    for (size_t n = 0; n < nTracks; n++) {
+        const Int_t parentId = input->fTrack[tracks[n]].GetTrackID();
+        for (auto& hits : solved[n]) EmplaceTrack(GetNumberOfTracks() + 1, parentId, std::move(hits));
+        if (!ok[n]) allOk = false;
+    }
+    return allOk;
+}
+
+///////////////////////////////////////////////
+/// \brief It updates the counters, the ID index and the hierarchy of the event
+/// after a track has been appended to fTrack.
+///
+void TRestTrackEvent::RegisterLastTrack() {
+    fMutationCount++;
+    TRestTrack* c = &fTrack.back();
     if (c->isXZ()) fNtracksX++;
     if (c->isYZ()) fNtracksY++;
     fNtracks++;
 
-    fTrack.emplace_back(*c);
+    const Int_t n = fTrack.size() - 1;
+    fTrackIndex.emplace(c->GetTrackID(), n);
+    fTracksType &= c->GetHitsType();
 
-    SetLevels();
+    if (!fLevelsUpdated || fTrackLevel.size() != (unsigned int)n) {
+        fLevelsUpdated = false;
+        return;
+    }
+
+    // The level and origin of the new track follow from its parent. If the parent is not
+    // yet in the event, the hierarchy will be recomputed the next time it is needed.
+    Int_t lvl = 1;
+    Int_t origin = n;
+    const Int_t pID = c->GetParentID();
+    if (pID > 0) {
+        const Int_t parent = GetTrackIndexById(pID);
+        if (parent < 0 || parent == n) {
+            fLevelsUpdated = false;
+            return;
+        }
+        lvl = fTrackLevel[parent] + 1;
+        origin = fTrackOrigin[parent];
+        fTrackChildren[parent].push_back(n);
+    }
+    fTrackLevel.push_back(lvl);
+    fTrackOrigin.push_back(origin);
+    fTrackChildren.emplace_back();
+
+    if (lvl > fLevels) {
+        fLevels = lvl;
+        fTopLevelTracks.clear();
+    }
+    if (lvl == fLevels) fTopLevelTracks.push_back(n);
+}
+
+///////////////////////////////////////////////
+/// \brief It appends a copy of all the tracks of the given event, as done by the
+/// processes to pass their input tracks through to the output event.
+///
+/// The storage for the tracks is reserved once. When this event is empty, the ID
+/// index and the track hierarchy of the given event are copied over instead of
+/// being built again track by track.
+///
+/// The hits of each track are copied too. They cannot be shared with the given
+/// event, since fVolumeHits is what the split event branches write, and there is
+/// no hook to fill it back from shared storage before the event is written.
+///
+void TRestTrackEvent::AddTracks(TRestTrackEvent* event) {
+    const Int_t nTracks = event->fTrack.size();
+
+    if (!fTrack.empty() || event == this) {
+        fTrack.reserve(fTrack.size() + nTracks);
+        for (int n = 0; n < nTracks; n++) AddTrack(&event->fTrack[n]);
+        return;
+    }
+
+    event->UpdateLevels();
+
+    fMutationCount++;
+    fTrack = event->fTrack;
+
+    fNtracks = nTracks;
+    fNtracksX = 0;
+    fNtracksY = 0;
+    for (auto& track : fTrack) {
+        if (track.isXZ()) fNtracksX++;
+        if (track.isYZ()) fNtracksY++;
+    }
+
+    fTrackIndex = event->fTrackIndex;
+    if (fTrackIndex.size() != fTrack.size()) RebuildTrackIndex();
+
+    fLevels = event->fLevels;
+    fTrackLevel = event->fTrackLevel;
+    fTopLevelTracks = event->fTopLevelTracks;
+    fTrackOrigin = event->fTrackOrigin;
+    fTrackChildren = event->fTrackChildren;
+    fTracksType = event->fTracksType;
+    fLevelsUpdated = true;
 }
 
 void TRestTrackEvent::RemoveTrack(int n) {
+    fMutationCount++;
     if (fTrack[n].isXZ()) fNtracksX--;
     if (fTrack[n].isYZ()) fNtracksY--;
     fNtracks--;
 
     fTrack.erase(fTrack.begin() + n);
+    RebuildTrackIndex();
 
     SetLevels();
 }
 
-Int_t TRestTrackEvent::GetNumberOfTracks(TString option) {
-    if (option == "")
-        return fNtracks;
-    else {
-        Int_t nT = 0;
-        for (int n = 0; n < GetNumberOfTracks(); n++) {
-            if (!this->isTopLevel(n)) continue;
-
-            if (option == "X" && GetTrack(n)->isXZ())
-                nT++;
-            else if (option == "Y" && GetTrack(n)->isYZ())
-                nT++;
-            else if (option == "XYZ" && GetTrack(n)->isXYZ())
-                nT++;
+///////////////////////////////////////////////
+/// \brief It removes the tracks for which the given predicate returns true, and it
+/// returns the number of tracks removed. The predicate is called once for each track,
+/// in order, and it must not modify the event.
+///
+/// The remaining tracks keep their order. They are compacted in a single pass, and the
+/// ID index and the track hierarchy are rebuilt once, instead of once per track as when
+/// calling RemoveTrack repeatedly.
+///
+Int_t TRestTrackEvent::RemoveTracksIf(const std::function<Bool_t(TRestTrack&)>& predicate) {
+    const Int_t nTracks = fTrack.size();
+    Int_t nKept = 0;
+    for (int tck = 0; tck < nTracks; tck++) {
+        TRestTrack& track = fTrack[tck];
+        if (predicate(track)) {
+            if (track.isXZ()) fNtracksX--;
+            if (track.isYZ()) fNtracksY--;
+            fNtracks--;
+            continue;
         }
-
-        return nT;
+        if (nKept != tck) fTrack[nKept] = std::move(track);
+        nKept++;
     }
 
-    return -1;
+    if (nKept == nTracks) return 0;
+
+    fMutationCount++;
+    fTrack.erase(fTrack.begin() + nKept, fTrack.end());
+    RebuildTrackIndex();
+
+    SetLevels();
+    return nTracks - nKept;
 }
 
-TRestTrack* TRestTrackEvent::GetTrackById(Int_t id) {
-    for (int i = 0; i < GetNumberOfTracks(); i++)
-        if (GetTrack(i)->GetTrackID() == id) return GetTrack(i);
-    return nullptr;
-}
-
-TRestTrack* TRestTrackEvent::GetMaxEnergyTrackInX() {
-    Int_t track = -1;
-    Double_t maxEnergy = 0;
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) {
-        if (!this->isTopLevel(tck)) continue;
-
-        TRestTrack* t = GetTrack(tck);
-        if (t->isXZ()) {
-            if (t->GetEnergy() > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
-        }
-    }
+void TRestTrackEvent::RemoveTracks() {
+    fMutationCount++;
+    fTrack.clear();
+    fTrackIndex.clear();
+    fTrackLevel.clear();
+    fTopLevelTracks.clear();
+    fTrackOrigin.clear();
+    fTrackChildren.clear();
+    fTracksType = TRestTrack::kHitsAll;
+    fLevels = 0;
+    fLevelsUpdated = true;
+}
 
-    if (track == -1) return nullptr;
+Int_t TRestTrackEvent::GetNumberOfTracks(TString option) {
+    if (option == "") return fNtracks;
+
+    UpdateSummary();
+    if (option == "X") return fTopLevelTracksCount[0];
+    if (option == "Y") return fTopLevelTracksCount[1];
+    if (option == "XYZ") return fTopLevelTracksCount[2];
 
-    return GetTrack(track);
+    return 0;
 }
 
-TRestTrack* TRestTrackEvent::GetMaxEnergyTrackInY() {
-    Int_t track = -1;
-    Double_t maxEnergy = 0;
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) {
-        if (!this->isTopLevel(tck)) continue;
+///////////////////////////////////////////////
+/// \brief It returns the track with the given track ID, or nullptr if it is not found.
+///
+/// The lookup goes through the transient ID-to-index map. The map is not streamed, so
+/// after reading the event from a file it might be stale. Any index obtained from it is
+/// validated against the stored track. Only when the map size disagrees with fTrack, or
+/// when an index fails the validation, fTrack is scanned and the map rebuilt from it.
+///
+TRestTrack* TRestTrackEvent::GetTrackById(Int_t id) {
+    const Int_t n = GetTrackIndexById(id);
+    if (n < 0) return nullptr;
+    return &fTrack[n];
+}
 
-        TRestTrack* t = GetTrack(tck);
-        if (t->isYZ()) {
-            if (t->GetEnergy() > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
-        }
+///////////////////////////////////////////////
+/// \brief It returns the position in fTrack of the track with the given ID, or -1.
+///
+Int_t TRestTrackEvent::GetTrackIndexById(Int_t id) {
+    if (fTrackIndex.size() == fTrack.size()) {
+        auto it = fTrackIndex.find(id);
+        if (it == fTrackIndex.end()) return -1;
+        if (it->second < (Int_t)fTrack.size() && fTrack[it->second].GetTrackID() == id) return it->second;
     }
 
-    if (track == -1) return nullptr;
+    for (unsigned int i = 0; i < fTrack.size(); i++) {
+        if (fTrack[i].GetTrackID() == id) {
+            RebuildTrackIndex();
+            return i;
+        }
+    }
+    return -1;
+}
 
-    return GetTrack(track);
+void TRestTrackEvent::RebuildTrackIndex() {
+    fTrackIndex.clear();
+    fTrackIndex.reserve(fTrack.size());
+    for (unsigned int i = 0; i < fTrack.size(); i++) fTrackIndex.emplace(fTrack[i].GetTrackID(), i);
 }
 
+TRestTrack* TRestTrackEvent::GetMaxEnergyTrackInX() { return GetMaxEnergyTrack("X"); }
+
+TRestTrack* TRestTrackEvent::GetMaxEnergyTrackInY() { return GetMaxEnergyTrack("Y"); }
+
 TRestTrack* TRestTrackEvent::GetMaxEnergyTrack(TString option) {
-    if (option == "X") return GetMaxEnergyTrackInX();
-    if (option == "Y") return GetMaxEnergyTrackInY();
-
-    Int_t track = -1;
-    Double_t maxEnergy = 0;
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) {
-        if (!this->isTopLevel(tck)) continue;
-
-        TRestTrack* t = GetTrack(tck);
-        if (t->isXYZ()) {
-            if (t->GetEnergy() > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
-        }
+    UpdateMaxEnergyTracks(1);
+
+    const auto& ranking = fMaxEnergyTracks[GetRankProjection(option)];
+    if (ranking.empty()) return nullptr;
+
+    return &fTrack[ranking[0]];
+}
+
+///////////////////////////////////////////////
+/// \brief It returns the second most energetic top level track. For the options "X"
+/// and "Y" the candidates are the XZ (or YZ) tracks together with the XYZ tracks,
+/// while the most energetic track is searched only among the XZ (or YZ) tracks.
+///
+TRestTrack* TRestTrackEvent::GetSecondMaxEnergyTrack(TString option) {
+    UpdateMaxEnergyTracks(2);
+
+    const Int_t projection = GetRankProjection(option);
+    const auto& ranking = fMaxEnergyTracks[projection];
+    if (ranking.empty()) return nullptr;
+
+    Int_t track = ranking.size() > 1 ? ranking[1] : -1;
+
+    if (projection != kRankXYZ && !fMaxEnergyTracks[kRankXYZ].empty()) {
+        const Int_t tck = fMaxEnergyTracks[kRankXYZ][0];
+        if (track == -1 || fTrack[tck].GetEnergy() > fTrack[track].GetEnergy() ||
+            (fTrack[tck].GetEnergy() == fTrack[track].GetEnergy() && tck < track))
+            track = tck;
     }
 
     if (track == -1) return nullptr;
 
-    return GetTrack(track);
+    return &fTrack[track];
 }
 
-TRestTrack* TRestTrackEvent::GetSecondMaxEnergyTrack(TString option) {
-    if (GetMaxEnergyTrack(option) == nullptr) return nullptr;
+///////////////////////////////////////////////
+/// \brief It returns up to k top level tracks with the highest energy, sorted by
+/// decreasing energy. The option "X" selects XZ tracks, "Y" selects YZ tracks and
+/// any other option selects XYZ tracks. Tracks without energy are never selected.
+///
+std::vector<TRestTrack*> TRestTrackEvent::GetMaxEnergyTracks(TString option, Int_t k) {
+    UpdateMaxEnergyTracks(k);
 
-    Int_t id = GetMaxEnergyTrack(option)->GetTrackID();
+    std::vector<TRestTrack*> tracks;
+    for (const auto& tck : fMaxEnergyTracks[GetRankProjection(option)]) {
+        if ((Int_t)tracks.size() == k) break;
+        tracks.push_back(&fTrack[tck]);
+    }
+    return tracks;
+}
 
-    Int_t track = -1;
-    Double_t maxEnergy = 0;
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) {
-        if (!this->isTopLevel(tck)) continue;
+///////////////////////////////////////////////
+/// \brief It ranks the top level tracks by energy for the XZ, YZ and XYZ projections
+/// in a single pass, keeping at least k tracks for each of them. The ranking is kept
+/// until the event is modified through AddTrack, RemoveTrack(s), SetLevels or
+/// Initialize. Energy ties are resolved in favour of the track added first.
+///
+void TRestTrackEvent::UpdateMaxEnergyTracks(Int_t k) {
+    UpdateLevels();
+    if (fMaxEnergyTracksMutation == fMutationCount && k <= fMaxEnergyTracksDepth) return;
 
-        TRestTrack* t = GetTrack(tck);
-        if (t->GetTrackID() == id) continue;
+    if (fMaxEnergyTracksMutation != fMutationCount) fMaxEnergyTracksDepth = 0;
+    fMaxEnergyTracksDepth = std::max(std::max(k, fMaxEnergyTracksDepth), 2);
 
-        Double_t en = t->GetEnergy();
+    fMaxEnergyTracks.assign(3, {});
+    for (const auto& tck : fTopLevelTracks) {
+        const Double_t en = fTrack[tck].GetEnergy();
+        if (en <= 0) continue;
 
-        if (option == "X" && (t->isXZ() || t->isXYZ())) {
-            if (en > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
-        } else if (option == "Y" && (t->isYZ() || t->isXYZ())) {
-            if (t->GetEnergy() > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
-        } else if (t->isXYZ()) {
-            if (t->GetEnergy() > maxEnergy) {
-                maxEnergy = t->GetEnergy();
-                track = tck;
-            }
+        for (int p = 0; p < 3; p++) {
+            if (!(fTrack[tck].GetHitsType() & kRankFlags[p])) continue;
+
+            auto& ranking = fMaxEnergyTracks[p];
+            auto it = ranking.end();
+            while (it != ranking.begin() && fTrack[*(it - 1)].GetEnergy() < en) --it;
+            if (it - ranking.begin() >= fMaxEnergyTracksDepth) continue;
+
+            ranking.insert(it, tck);
+            if ((Int_t)ranking.size() > fMaxEnergyTracksDepth) ranking.pop_back();
         }
     }
 
-    if (track == -1) return nullptr;
-
-    return GetTrack(track);
+    fMaxEnergyTracksMutation = fMutationCount;
 }
 
 Double_t TRestTrackEvent::GetMaxEnergyTrackVolume(TString option) {
-    if (this->GetMaxEnergyTrack(option)) return this->GetMaxEnergyTrack(option)->GetVolume();
+    TRestTrack* track = GetMaxEnergyTrack(option);
+    if (track) return track->GetVolume();
     return 0;
 }
 
 Double_t TRestTrackEvent::GetMaxEnergyTrackLength(TString option) {
-    if (this->GetMaxEnergyTrack(option)) return this->GetMaxEnergyTrack(option)->GetLength();
+    TRestTrack* track = GetMaxEnergyTrack(option);
+    if (track) return track->GetLength();
     return 0;
 }
 
 Double_t TRestTrackEvent::GetEnergy(TString option) {
-    Double_t en = 0;
-    for (int tck = 0; tck < this->GetNumberOfTracks(); tck++) {
-        if (!this->isTopLevel(tck)) continue;
+    UpdateSummary();
+    if (option == "") return fTopLevelEnergy[0];
+    if (option == "X") return fTopLevelEnergy[1];
+    if (option == "Y") return fTopLevelEnergy[2];
+    if (option == "XYZ") return fTopLevelEnergy[3];
 
-        TRestTrack* t = GetTrack(tck);
+    return 0;
+}
 
-        if (option == "")
-            en += t->GetEnergy();
+///////////////////////////////////////////////
+/// \brief It computes the energies and number of tracks of the top level tracks
+/// for each projection, and the total number of hits. The values are kept until
+/// the event is modified through AddTrack, RemoveTrack(s), SetLevels or Initialize.
+///
+void TRestTrackEvent::UpdateSummary() {
+    UpdateLevels();
+    if (fSummaryMutation == fMutationCount) return;
 
-        else if (option == "X" && (t->isXZ() || t->isXYZ()))
-            en += t->GetEnergy();
+    for (auto& en : fTopLevelEnergy) en = 0;
+    for (auto& n : fTopLevelTracksCount) n = 0;
 
-        else if (option == "Y" && (t->isYZ() || t->isXYZ()))
-            en += t->GetEnergy();
+    for (const auto& tck : fTopLevelTracks) {
+        TRestTrack& t = fTrack[tck];
+        const Double_t en = t.GetEnergy();
 
-        else if (option == "XYZ" && t->isXYZ())
-            en += t->GetEnergy();
+        fTopLevelEnergy[0] += en;
+        if (t.isXZ() || t.isXYZ()) fTopLevelEnergy[1] += en;
+        if (t.isYZ() || t.isXYZ()) fTopLevelEnergy[2] += en;
+        if (t.isXYZ()) fTopLevelEnergy[3] += en;
+
+        if (t.isXZ()) fTopLevelTracksCount[0]++;
+        if (t.isYZ()) fTopLevelTracksCount[1]++;
+        if (t.isXYZ()) fTopLevelTracksCount[2]++;
     }
 
-    return en;
+    fTotalHits = 0;
+    for (auto& t : fTrack) fTotalHits += t.GetNumberOfHits();
+
+    fSummaryMutation = fMutationCount;
 }
 
 Bool_t TRestTrackEvent::isXYZ() {
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++)
-        if (!fTrack[tck].isXYZ()) return false;
-    return true;
+    UpdateLevels();
+    return fTracksType & TRestTrack::kHitsXYZ;
 }
 
 Int_t TRestTrackEvent::GetTotalHits() {
-    Int_t totHits = 0;
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) totHits += GetTrack(tck)->GetNumberOfHits();
-    return totHits;
+    UpdateSummary();
+    return fTotalHits;
 }
 
 Int_t TRestTrackEvent::GetLevel(Int_t tck) {
-    Int_t lvl = 1;
-    Int_t parentTrackId = GetTrack(tck)->GetParentID();
-
-    while (parentTrackId > 0) {
-        lvl++;
-        parentTrackId = GetTrackById(parentTrackId)->GetParentID();
-    }
-    return lvl;
+    UpdateLevels();
+    return fTrackLevel[tck];
 }
 
 Bool_t TRestTrackEvent::isTopLevel(Int_t tck) {
-    if (GetLevels() == GetLevel(tck)) return true;
-    return false;
+    UpdateLevels();
+    return fTrackLevel[tck] == fLevels;
 }
 
-Int_t TRestTrackEvent::GetOriginTrackID(Int_t tck) {
-    Int_t originTrackID = tck;
-    Int_t pID = GetTrack(tck)->GetParentID();
+///////////////////////////////////////////////
+/// \brief It returns the positions in fTrack of the tracks at the highest level,
+/// in increasing order.
+///
+const std::vector<Int_t>& TRestTrackEvent::GetTopLevelTracks() {
+    UpdateLevels();
+    return fTopLevelTracks;
+}
 
-    while (pID != 0) {
-        originTrackID = pID;
-        pID = GetTrackById(originTrackID)->GetParentID();
-    }
+///////////////////////////////////////////////
+/// \brief It returns an estimate of the memory in bytes taken by the event, split
+/// into the hit columns of the tracks, the track objects with the bookkeeping of
+/// their hierarchy and the graphs and histograms kept by DrawEvent and DrawHits.
+///
+/// Containers count their reserved capacity, except the hits of the tracks, which
+/// are counted as described in TRestTrack::GetHitsMemoryFootprint.
+///
+TRestTrackEvent::MemoryFootprint TRestTrackEvent::GetMemoryFootprint() const {
+    MemoryFootprint footprint;
+
+    footprint.fTracks = sizeof(TRestTrackEvent) + fTrack.capacity() * sizeof(TRestTrack);
+    for (const auto& track : fTrack) footprint.fHits += track.GetHitsMemoryFootprint();
+
+    for (auto positions : {&fTrackLevel, &fTopLevelTracks, &fTrackOrigin})
+        footprint.fTracks += positions->capacity() * sizeof(Int_t);
+    footprint.fTracks += fTrackChildren.capacity() * sizeof(std::vector<Int_t>);
+    for (const auto& children : fTrackChildren) footprint.fTracks += children.capacity() * sizeof(Int_t);
+    footprint.fTracks += fMaxEnergyTracks.capacity() * sizeof(std::vector<Int_t>);
+    for (const auto& ranking : fMaxEnergyTracks) footprint.fTracks += ranking.capacity() * sizeof(Int_t);
+    // Each element of the index is a node holding the pair and the link to the next one
+    footprint.fTracks += fTrackIndex.bucket_count() * sizeof(void*) +
+                         fTrackIndex.size() * (sizeof(std::pair<const Int_t, Int_t>) + sizeof(void*));
+
+    for (auto graphs : {&fXYHit, &fXZHit, &fYZHit, &fXYTrack, &fXZTrack, &fYZTrack})
+        for (auto gr : *graphs) footprint.fDrawing += sizeof(TGraph) + 2 * sizeof(Double_t) * gr->GetN();
+    for (auto graphs : {&fXYZHit, &fXYZTrack})
+        for (auto gr : *graphs) footprint.fDrawing += sizeof(TGraph2D) + 3 * sizeof(Double_t) * gr->GetN();
+    for (auto histo : {fXZHits, fYZHits})
+        if (histo != nullptr) footprint.fDrawing += sizeof(TH2F) + sizeof(Float_t) * histo->GetNcells();
+
+    return footprint;
+}
 
-    return originTrackID;
+///////////////////////////////////////////////
+/// \brief It sets the observables inputMemoryFootprint and outputMemoryFootprint of
+/// the process given to the total memory, in bytes, taken by its input and output
+/// events. The track processes call it when their memoryFootprint parameter is true.
+///
+void TRestTrackEvent::SetMemoryFootprintObservables(TRestEventProcess* process, const TRestTrackEvent* input,
+                                                    const TRestTrackEvent* output) {
+    const Double_t inputFootprint = input->GetMemoryFootprint().GetTotal();
+    const Double_t outputFootprint =
+        output == input ? inputFootprint : (Double_t)output->GetMemoryFootprint().GetTotal();
+    process->SetObservableValue("inputMemoryFootprint", inputFootprint);
+    process->SetObservableValue("outputMemoryFootprint", outputFootprint);
 }
 
+///////////////////////////////////////////////
+/// \brief It returns the track ID of the first level track from which the track
+/// at position tck originates.
+///
+Int_t TRestTrackEvent::GetOriginTrackID(Int_t tck) { return GetOriginTrack(tck)->GetTrackID(); }
+
 TRestTrack* TRestTrackEvent::GetOriginTrack(Int_t tck) {
-    Int_t originTrackID = GetTrack(tck)->GetTrackID();
-    Int_t pID = GetTrackById(originTrackID)->GetParentID();
+    UpdateLevels();
+    return &fTrack[fTrackOrigin[tck]];
+}
 
-    while (pID != 0) {
-        originTrackID = pID;
-        pID = GetTrackById(originTrackID)->GetParentID();
-    }
+TRestTrack* TRestTrackEvent::GetOriginTrackById(Int_t tckId) {
+    const Int_t tck = GetTrackIndexById(tckId);
+    if (tck < 0) return nullptr;
+    return GetOriginTrack(tck);
+}
 
-    return GetTrackById(originTrackID);
+///////////////////////////////////////////////
+/// \brief It returns the positions in fTrack of the tracks whose parent is the
+/// track at position tck.
+///
+const std::vector<Int_t>& TRestTrackEvent::GetChildren(Int_t tck) {
+    UpdateLevels();
+    return fTrackChildren[tck];
 }
 
-TRestTrack* TRestTrackEvent::GetOriginTrackById(Int_t tckId) {
-    Int_t originTrackID = tckId;
-    Int_t pID = GetTrackById(tckId)->GetParentID();
+///////////////////////////////////////////////
+/// \brief It returns the positions in fTrack of all the tracks derived from the
+/// track with ID tckId (children, grandchildren, ...), ordered level by level.
+/// The track itself is not included.
+///
+std::vector<Int_t> TRestTrackEvent::GetDescendants(Int_t tckId) {
+    std::vector<Int_t> descendants;
 
-    while (pID != 0) {
-        originTrackID = pID;
-        pID = GetTrackById(originTrackID)->GetParentID();
-    }
+    const Int_t tck = GetTrackIndexById(tckId);
+    if (tck < 0) return descendants;
 
-    return GetTrackById(originTrackID);
+    UpdateLevels();
+    descendants = fTrackChildren[tck];
+    for (unsigned int n = 0; n < descendants.size(); n++) {
+        const auto& children = fTrackChildren[descendants[n]];
+        descendants.insert(descendants.end(), children.begin(), children.end());
+    }
+    return descendants;
 }
 
+///////////////////////////////////////////////
+/// \brief It recomputes the level of every track, the number of levels and the
+/// list of top level tracks.
+///
+/// The origin track and the children of each track are rebuilt in the same pass.
+/// Each parent chain is walked only until a track with an already known level is
+/// found, so the whole event is processed in linear time. A track whose parent is
+/// not present in the event is considered to be at the first level.
+///
 void TRestTrackEvent::SetLevels() {
-    Int_t maxLevel = 0;
+    fMutationCount++;
+    const Int_t nTracks = fTrack.size();
+    fTrackLevel.assign(nTracks, 0);
+    fTrackOrigin.assign(nTracks, -1);
+    fTrackChildren.assign(nTracks, {});
 
-    for (int tck = 0; tck < GetNumberOfTracks(); tck++) {
-        Int_t lvl = GetLevel(tck);
-        if (maxLevel < lvl) maxLevel = lvl;
+    std::vector<Int_t> parent(nTracks, -1);
+    for (int tck = 0; tck < nTracks; tck++) {
+        const Int_t pID = fTrack[tck].GetParentID();
+        if (pID > 0) parent[tck] = GetTrackIndexById(pID);
+        if (parent[tck] >= 0) fTrackChildren[parent[tck]].push_back(tck);
     }
+
+    std::vector<Int_t> chain;
+    for (int tck = 0; tck < nTracks; tck++) {
+        if (fTrackLevel[tck] > 0) continue;
+
+        Int_t t = tck;
+        chain.clear();
+        while (t >= 0 && fTrackLevel[t] == 0 && (Int_t)chain.size() < nTracks) {
+            chain.push_back(t);
+            t = parent[t];
+        }
+
+        Int_t lvl = 0;
+        Int_t origin = chain.back();
+        if (t >= 0 && fTrackLevel[t] > 0) {
+            lvl = fTrackLevel[t];
+            origin = fTrackOrigin[t];
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            fTrackLevel[*it] = ++lvl;
+            fTrackOrigin[*it] = origin;
+        }
+    }
+
+    Int_t maxLevel = 0;
+    for (const auto& lvl : fTrackLevel)
+        if (maxLevel < lvl) maxLevel = lvl;
     fLevels = maxLevel;
+
+    fTracksType = TRestTrack::kHitsAll;
+    for (auto& track : fTrack) fTracksType &= track.GetHitsType();
+
+    fTopLevelTracks.clear();
+    for (int tck = 0; tck < nTracks; tck++)
+        if (fTrackLevel[tck] == fLevels) fTopLevelTracks.push_back(tck);
+
+    fLevelsUpdated = true;
+}
+
+void TRestTrackEvent::UpdateLevels() {
+    if (fLevelsUpdated && fTrackLevel.size() == fTrack.size()) return;
+    SetLevels();
 }
 
 ///////////////////////////////////////////////
@@ -322,57 +778,85 @@ void TRestTrackEvent::SetLevels() {
 /// of the track is defined as the further edge to the half integral, while the track
 /// end is defined as the closest edge.
 ///
+/// It returns the 3D hits of the track. Use the overload taking a TRestVolumeHits
+/// pointer when only the origin and end are needed.
+///
 TRestVolumeHits TRestTrackEvent::GetMaxTrackBoundaries3D(TVector3& orig, TVector3& end) {
+    TRestVolumeHits hits3D;
+    GetMaxTrackBoundaries3D(orig, end, &hits3D);
+    return hits3D;
+}
+
+///////////////////////////////////////////////
+/// \brief It computes the origin and end of the 3D track as GetMaxTrackBoundaries3D
+/// above, reading the hits of the most energetic XZ and YZ tracks in place. The 3D
+/// hits are only built when hits3D is not nullptr. It returns false, leaving orig
+/// and end untouched, if there is no XZ or YZ track.
+///
+/// The direction is chosen from the first and last 3D hits, which are known without
+/// building the rest, and then a single pass over the hits finds the half integral.
+///
+Bool_t TRestTrackEvent::GetMaxTrackBoundaries3D(TVector3& orig, TVector3& end, TRestVolumeHits* hits3D) {
+    if (hits3D != nullptr) hits3D->RemoveHits();
+
     TRestTrack* tckX = GetMaxEnergyTrackInX();
     TRestTrack* tckY = GetMaxEnergyTrackInY();
 
     if (tckX == nullptr || tckY == nullptr) {
         RESTWarning << "Track is empty, skipping" << RESTendl;
-        return {};
+        return false;
     }
 
-    TRestVolumeHits hitsX = (TRestVolumeHits) * (tckX->GetVolumeHits());
-    TRestVolumeHits hitsY = (TRestVolumeHits) * (tckY->GetVolumeHits());
+    const TRestVolumeHits& hitsX = *tckX->GetVolumeHits();
+    const TRestVolumeHits& hitsY = *tckY->GetVolumeHits();
 
     const int nHits = std::min(hitsX.GetNumberOfHits(), hitsY.GetNumberOfHits());
-    TRestVolumeHits best3DHits, hits3D;
-
-    for (int i = 0; i < nHits; i++) {
-        double enX = hitsX.GetEnergy(i);
-        double enY = hitsY.GetEnergy(i);
-        double posXZ = hitsX.GetZ(i);
-        double posYZ = hitsY.GetZ(i);
-        double avgZ = (enX * posXZ + enY * posYZ) / (enX + enY);
-        best3DHits.AddHit(hitsX.GetX(i), hitsY.GetY(i), avgZ, enX + enY, 0, XYZ, 0, 0, 0);
-        const int j = nHits - i - 1;
-        enY = hitsY.GetEnergy(j);
-        posYZ = hitsY.GetZ(j);
-        avgZ = (enX * posXZ + enY * posYZ) / (enX + enY);
-        hits3D.AddHit(hitsX.GetX(i), hitsY.GetY(j), avgZ, enX + enY, 0, XYZ, 0, 0, 0);
-    }
-
-    double length = (best3DHits.GetPosition(0) - best3DHits.GetPosition(nHits - 1)).Mag();
-
-    if ((hits3D.GetPosition(0) - hits3D.GetPosition(nHits - 1)).Mag() > length) {
-        best3DHits = hits3D;
+    if (nHits == 0) {
+        RESTWarning << "Track is empty, skipping" << RESTendl;
+        return false;
     }
 
+    // The 3D hit i pairs the XZ hit i with the YZ hit i, or with the YZ hit nHits - i - 1
+    // when reversed. The coordinates are rounded as they are stored in TRestVolumeHits.
+    Bool_t reversed = false;
+    auto position = [&](int i) {
+        const int j = reversed ? nHits - i - 1 : i;
+        const double enX = hitsX.GetEnergy(i);
+        const double enY = hitsY.GetEnergy(j);
+        const double avgZ = (enX * hitsX.GetZ(i) + enY * hitsY.GetZ(j)) / (enX + enY);
+        return TVector3((Float_t)hitsX.GetX(i), (Float_t)hitsY.GetY(j), (Float_t)avgZ);
+    };
+
+    const double length = (position(0) - position(nHits - 1)).Mag();
+    reversed = true;
+    if ((position(0) - position(nHits - 1)).Mag() <= length) reversed = false;
+
+    // The pairing does not change the total energy
     double totEn = 0;
-    for (unsigned int i = 0; i < best3DHits.GetNumberOfHits(); i++) {
-        totEn += best3DHits.GetEnergy(i);
+    if ((int)hitsX.GetNumberOfHits() == nHits && (int)hitsY.GetNumberOfHits() == nHits) {
+        totEn = hitsX.GetTotalEnergy() + hitsY.GetTotalEnergy();
+    } else {
+        for (int i = 0; i < nHits; i++) totEn += hitsX.GetEnergy(i) + hitsY.GetEnergy(i);
     }
 
-    const TVector3 pos0 = best3DHits.GetPosition(0);
-    const TVector3 posE = best3DHits.GetPosition(best3DHits.GetNumberOfHits() - 1);
-
     double integ = 0;
-    unsigned int pos = 0;
-    for (pos = 0; pos < best3DHits.GetNumberOfHits(); pos++) {
-        integ += best3DHits.GetEnergy(pos);
-        if (integ > totEn / 2.) break;
+    int pos = -1;
+    for (int i = 0; i < nHits; i++) {
+        const double energy = hitsX.GetEnergy(i) + hitsY.GetEnergy(reversed ? nHits - i - 1 : i);
+        if (hits3D != nullptr) hits3D->AddHit(position(i), energy, 0, XYZ, TVector3(0, 0, 0));
+
+        integ += energy;
+        if (pos < 0 && integ > totEn / 2.) {
+            pos = i;
+            if (hits3D == nullptr) break;
+        }
     }
+    if (pos < 0) pos = nHits - 1;
+
+    const TVector3 pos0 = position(0);
+    const TVector3 posE = position(nHits - 1);
 
-    auto intPos = best3DHits.GetPosition(pos);
+    auto intPos = position(pos);
     const double intToFirst = (pos0 - intPos).Mag();
     const double intToLast = (posE - intPos).Mag();
 
@@ -388,7 +872,7 @@ TRestVolumeHits TRestTrackEvent::GetMaxTrackBoundaries3D(TVector3& orig, TVector
     RESTDebug << "Origin " << orig.X() << " " << orig.Y() << " " << orig.Z() << RESTendl;
     RESTDebug << "End    " << end.X() << " " << end.Y() << " " << end.Z() << RESTendl;
 
-    return best3DHits;
+    return true;
 }
 
 ///////////////////////////////////////////////
@@ -425,6 +909,19 @@ void TRestTrackEvent::GetMaxTrackBoundaries(TVector3& orig, TVector3& end) {
 /// track to crosscheck if the track is upwards or downwards
 ///
 Double_t TRestTrackEvent::GetMaxTrackRelativeZ() {
+    std::vector<std::pair<Double_t, Double_t> > zEn;
+    return GetMaxTrackRelativeZ(zEn);
+}
+
+///////////////////////////////////////////////
+/// \brief Same as GetMaxTrackRelativeZ(), using zEn as scratch buffer for the Z
+/// and energy of the hits. A caller that keeps the buffer between events avoids
+/// allocating it for each event.
+///
+/// The relative Z is (zMin - zMedian) / (zMin - zMax), where zMedian is the energy
+/// weighted median of the Z of the hits of the most energetic XZ and YZ tracks.
+///
+Double_t TRestTrackEvent::GetMaxTrackRelativeZ(std::vector<std::pair<Double_t, Double_t> >& zEn) {
     TRestTrack* tckX = GetMaxEnergyTrackInX();
     TRestTrack* tckY = GetMaxEnergyTrackInY();
 
@@ -433,39 +930,67 @@ Double_t TRestTrackEvent::GetMaxTrackRelativeZ() {
         return -1;
     }
 
-    std::vector<std::pair<double, double> > zEn;
-    double totEn = 0;
+    zEn.clear();
+    for (auto hits : {tckX->GetVolumeHits(), tckY->GetVolumeHits()})
+        for (size_t i = 0; i < hits->GetNumberOfHits(); i++)
+            zEn.emplace_back(hits->GetZ(i), hits->GetEnergy(i));
 
-    for (size_t i = 0; i < tckX->GetVolumeHits()->GetNumberOfHits(); i++) {
-        double en = tckX->GetVolumeHits()->GetEnergy(i);
-        double z = tckX->GetVolumeHits()->GetZ(i);
-        zEn.emplace_back(std::make_pair(z, en));
-        totEn += en;
-    }
+    if (zEn.empty()) return 0;
 
-    for (size_t i = 0; i < tckY->GetVolumeHits()->GetNumberOfHits(); i++) {
-        double en = tckY->GetVolumeHits()->GetEnergy(i);
-        double z = tckY->GetVolumeHits()->GetZ(i);
-        zEn.emplace_back(std::make_pair(z, en));
-        totEn += en;
-    }
+    const auto minMax = std::minmax_element(zEn.begin(), zEn.end());
+    const double length = minMax.first->first - minMax.second->first;
+    if (length == 0) return 0;
 
-    std::sort(zEn.begin(), zEn.end());
+    const double zFirst = minMax.first->first;
+    const double zMedian = GetWeightedQuantile(zEn, 0.5);
 
-    double integ = 0;
-    size_t pos = 0;
-    for (pos = 0; pos < zEn.size(); pos++) {
-        integ += zEn[pos].second;
-        if (integ >= totEn / 2.) break;
-    }
+    return (zFirst - zMedian) / length;
+}
 
-    double length = zEn.front().first - zEn.back().first;
-    double diff = zEn.front().first - zEn[pos].first;
+///////////////////////////////////////////////
+/// \brief It returns the weighted quantile of the given (value, weight) pairs, the
+/// smallest value at which the accumulated weight of the values sorted in increasing
+/// order reaches the given fraction of the total weight. For instance, with the
+/// position of the hits along an axis and their energy, a fraction of 0.5 gives the
+/// position splitting the energy in two halves.
+///
+/// It uses a selection algorithm, linear on average, instead of sorting the values.
+/// The weights are expected to be non negative, and the pairs are reordered.
+///
+Double_t TRestTrackEvent::GetWeightedQuantile(std::vector<std::pair<Double_t, Double_t> >& values,
+                                              Double_t fraction) {
+    if (values.empty()) return 0;
+
+    double total = 0;
+    for (const auto& v : values) total += v.second;
+    const double target = fraction * total;
+
+    auto byValue = [](const std::pair<Double_t, Double_t>& a, const std::pair<Double_t, Double_t>& b) {
+        return a.first < b.first;
+    };
+
+    // The answer is always inside [first, last), and below is the weight of the values before first
+    auto first = values.begin();
+    auto last = values.end();
+    double below = 0;
+    while (first != last) {
+        auto mid = first + (last - first) / 2;
+        std::nth_element(first, mid, last, byValue);
+
+        double lower = below;
+        for (auto it = first; it != mid; ++it) lower += it->second;
+
+        if (first != mid && lower >= target) {
+            last = mid;
+        } else if (lower + mid->second >= target || mid + 1 == last) {
+            return mid->first;
+        } else {
+            below = lower + mid->second;
+            first = mid + 1;
+        }
+    }
 
-    if (length == 0)
-        return 0;
-    else
-        return diff / length;
+    return values.back().first;
 }
 
 void TRestTrackEvent::PrintOnlyTracks() {
@@ -554,16 +1079,19 @@ TPad* TRestTrackEvent::DrawHits() {
     return fHitsPad;
 }
 
-// Draw current event in a Tpad
+///////////////////////////////////////////////
+/// \brief It draws the event in a TPad, with the XZ and YZ projections, and the XY
+/// projection and 3D view when the event is XYZ.
+///
+/// The hits of each track are drawn with one marker graph per projection and marker
+/// size, and the line of each track with one graph per projection. The marker size of
+/// the top level hits encodes their energy, rounded to steps of 0.2. The graphs are
+/// kept by the event and reused in the next call, so that the drawing time scales with
+/// the number of tracks instead of the number of hits.
+///
+/// Options: "print", "maxLevel=N" and "minLevel=N".
+///
 TPad* TRestTrackEvent::DrawEvent(const TString& option) {
-    /* Not used for the moment
-    Bool_t drawXZ = false;
-    Bool_t drawYZ = false;
-    Bool_t drawXY = false;
-    Bool_t drawXYZ = false;
-    Bool_t drawLines = false;
-    */
-
     Int_t maxLevel = 0;
     Int_t minLevel = 0;
 
@@ -571,20 +1099,11 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
 
     for (unsigned int n = 0; n < optList.size(); n++) {
         if (optList[n] == "print") this->PrintEvent();
-        if (optList[n] == "noWarning") fPrintHitsWarning = false;
     }
 
     optList.erase(std::remove(optList.begin(), optList.end(), "print"), optList.end());
-    optList.erase(std::remove(optList.begin(), optList.end(), "noWarning"), optList.end());
 
     for (unsigned int n = 0; n < optList.size(); n++) {
-        /* Not used for the moment
-        if( optList[n] == "XZ" ) drawXZ = true;
-        if( optList[n] == "YZ" ) drawYZ = true;
-        if( optList[n] == "XY" ) drawXY = true;
-        if( optList[n] == "XYZ" ) drawXYZ = true;
-        if( optList[n] == "L" || optList[n] == "lines"  ) drawLines = true;
-        */
         string opt = optList[n];
 
         if (opt.find("maxLevel=") != string::npos) maxLevel = stoi(opt.substr(9, opt.length()).c_str());
@@ -592,38 +1111,6 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
         if (opt.find("minLevel=") != string::npos) minLevel = stoi(opt.substr(9, opt.length()).c_str());
     }
 
-    if (fXYHit != nullptr) {
-        delete[] fXYHit;
-        fXYHit = nullptr;
-    }
-    if (fXZHit != nullptr) {
-        delete[] fXZHit;
-        fXZHit = nullptr;
-    }
-    if (fYZHit != nullptr) {
-        delete[] fYZHit;
-        fYZHit = nullptr;
-    }
-    if (fXYZHit != nullptr) {
-        delete[] fXYZHit;
-        fXYZHit = nullptr;
-    }
-    if (fXYTrack != nullptr) {
-        delete[] fXYTrack;
-        fXYTrack = nullptr;
-    }
-    if (fXZTrack != nullptr) {
-        delete[] fXZTrack;
-        fXZTrack = nullptr;
-    }
-    if (fYZTrack != nullptr) {
-        delete[] fYZTrack;
-        fYZTrack = nullptr;
-    }
-    if (fXYZTrack != nullptr) {
-        delete[] fXYZTrack;
-        fXYZTrack = nullptr;
-    }
     if (fPad != nullptr) {
         delete fPad;
         fPad = nullptr;
@@ -640,45 +1127,15 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
 
     double maxX = -1e10, minX = 1e10, maxZ = -1e10, minZ = 1e10, maxY = -1e10, minY = 1e10;
 
-    Int_t nTotHits = GetTotalHits();
-
-    if (fPrintHitsWarning && nTotHits > 5000) {
-        cout << endl;
-        cout << " REST WARNING. TRestTrackEvent::DrawEvent. Number of hits is too "
-                "high."
-             << endl;
-        cout << " This drawing method is not properly optimized to draw events "
-                "with a high number of hits."
-             << endl;
-        cout << " To remove this warning you may use the DrawEvent method option : "
-                "noWarning "
-             << endl;
-        cout << endl;
-
-        fPrintHitsWarning = false;
-    }
+    // Number of graphs of each kind used by this event
+    size_t countXY = 0, countYZ = 0, countXZ = 0, countXYZ = 0;
+    size_t nTckXY = 0, nTckXZ = 0, nTckYZ = 0, nTckXYZ = 0;
 
-    fXYHit = new TGraph[nTotHits];
-    fXZHit = new TGraph[nTotHits];
-    fYZHit = new TGraph[nTotHits];
-    fXYZHit = new TGraph2D[nTotHits];
-    fXYTrack = new TGraph[nTracks];
-    fXZTrack = new TGraph[nTracks];
-    fYZTrack = new TGraph[nTracks];
-    fXYZTrack = new TGraph2D[nTracks];
+    vector<Int_t> drawLinesXY, drawLinesXZ, drawLinesYZ, drawLinesXYZ;
 
-    vector<Int_t> drawLinesXY(nTracks, 0);
-    vector<Int_t> drawLinesXZ(nTracks, 0);
-    vector<Int_t> drawLinesYZ(nTracks, 0);
-    vector<Int_t> drawLinesXYZ(nTracks, 0);
-
-    int countXY = 0, countYZ = 0, countXZ = 0, countXYZ = 0;
-    int nTckXY = 0, nTckXZ = 0, nTckYZ = 0, nTckXYZ = 0;
-
-    Double_t minRadiusSize = 0.4;
-    Double_t maxRadiusSize = 2.;
-
-    Int_t maxTrackHits = 0;
+    const Double_t minRadiusSize = 0.4;
+    const Double_t maxRadiusSize = 2.;
+    const Double_t markerSizeStep = 0.2;
 
     Int_t tckColor = 1;
 
@@ -688,12 +1145,6 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
         Double_t maxHitEnergy = hits->GetMaximumHitEnergy();
         Double_t meanHitEnergy = hits->GetMeanHitEnergy();
 
-        /*
-        cout << "Max hit energy : " << maxHitEnergy << endl;
-        cout << "Mean hit energy : " << meanHitEnergy << endl;
-        cout << "Number of hits " << hits->GetNumberOfHits( ) <<endl;
-        */
-
         Bool_t isTopLevel = this->isTopLevel(tck);
         if (isTopLevel) tckColor++;
         Int_t level = this->GetLevel(tck);
@@ -702,12 +1153,20 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
 
         if (!isTopLevel && minLevel > 0 && level < minLevel) continue;
 
-        int tckXY = 0, tckYZ = 0, tckXZ = 0, tckXYZ = 0;
+        const Int_t hitsColor = isTopLevel ? tckColor : level + 11;
+
+        // Marker graphs of this track, by marker size step
+        map<Int_t, TGraph*> xyHits, xzHits, yzHits;
+        map<Int_t, TGraph2D*> xyzHits;
+
+        TGraph* xyTrack = nullptr;
+        TGraph* xzTrack = nullptr;
+        TGraph* yzTrack = nullptr;
+        TGraph2D* xyzTrack = nullptr;
+
         Double_t radius;
 
         for (unsigned int nhit = 0; nhit < hits->GetNumberOfHits(); nhit++) {
-            if (hits->GetNumberOfHits() > (unsigned int)maxTrackHits) maxTrackHits = hits->GetNumberOfHits();
-
             if (hits->isNaN(nhit)) {
                 cout << "REST Warning. TRestTrackEvent::Draw. Hit is not defined!!" << endl;
                 getchar();
@@ -720,8 +1179,6 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
             Double_t en = hits->GetEnergy(nhit);
             auto type = hits->GetType(nhit);
 
-            // cout << x << " " << y << " " << z << " " << type << endl;
-
             /* {{{ Hit size definition (radius) */
             Double_t m = (maxRadiusSize) / (maxHitEnergy - meanHitEnergy);
             Double_t n = (maxRadiusSize - minRadiusSize) - m * meanHitEnergy;
@@ -737,75 +1194,52 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
             }
             /* }}} */
 
-            if (this->isXYZ() && nhit > 1) {
-                if (tckXYZ == 0) nTckXYZ++;
-                fXYZTrack[nTckXYZ - 1].SetPoint(tckXYZ, x, y, z);
+            const Int_t sizeStep = std::max(1, (Int_t)TMath::Nint(radius / markerSizeStep));
 
-                if (isTopLevel) drawLinesXYZ[nTckXYZ - 1] = 1;
+            if (this->isXYZ() && nhit > 1) {
+                if (xyzTrack == nullptr) {
+                    xyzTrack = GetDrawingGraph(fXYZTrack, nTckXYZ);
+                    drawLinesXYZ.push_back(isTopLevel);
+                }
+                xyzTrack->SetPoint(xyzTrack->GetN(), x, y, z);
 
                 if (isTopLevel) {
-                    fXYZHit[countXYZ].SetPoint(0, x, y, z);
-                    // If there is only one-point the TGraph2D does NOT draw the point!
-                    fXYZHit[countXYZ].SetPoint(1, x + 0.001, y + 0.001, z + 0.001);
-
-                    fXYZHit[countXYZ].SetMarkerColor(level + 11);
-
-                    fXYZHit[countXYZ].SetMarkerSize(radius);
-                    fXYZHit[countXYZ].SetMarkerStyle(20);
-                    countXYZ++;
+                    TGraph2D*& gr = xyzHits[sizeStep];
+                    if (gr == nullptr) {
+                        gr = GetDrawingGraph(fXYZHit, countXYZ);
+                        gr->SetMarkerColor(level + 11);
+                        gr->SetMarkerSize(sizeStep * markerSizeStep);
+                        gr->SetMarkerStyle(20);
+                    }
+                    gr->SetPoint(gr->GetN(), x, y, z);
                 }
-                tckXYZ++;
             }
 
             if (type == XY) {
-                if (tckXY == 0) nTckXY++;
-                fXYTrack[nTckXY - 1].SetPoint(tckXY, x, y);
-                if (isTopLevel) drawLinesXY[nTckXY - 1] = 1;
-                fXYHit[countXY].SetPoint(0, x, y);
-
-                if (!isTopLevel)
-                    fXYHit[countXY].SetMarkerColor(level + 11);
-                else
-                    fXYHit[countXY].SetMarkerColor(tckColor);
-
-                fXYHit[countXY].SetMarkerSize(radius);
-                fXYHit[countXY].SetMarkerStyle(20);
-                tckXY++;
-                countXY++;
+                if (xyTrack == nullptr) {
+                    xyTrack = GetDrawingGraph(fXYTrack, nTckXY);
+                    drawLinesXY.push_back(isTopLevel);
+                }
+                xyTrack->SetPoint(xyTrack->GetN(), x, y);
+                AddDrawingHit(xyHits[sizeStep], fXYHit, countXY, hitsColor, sizeStep * markerSizeStep, x, y);
             }
 
             if (type == XZ) {
-                if (tckXZ == 0) nTckXZ++;
-                fXZTrack[nTckXZ - 1].SetPoint(tckXZ, x, z);
-                if (isTopLevel) drawLinesXZ[nTckXZ - 1] = 1;
-                fXZHit[countXZ].SetPoint(0, x, z);
-
-                if (!isTopLevel)
-                    fXZHit[countXZ].SetMarkerColor(level + 11);
-                else
-                    fXZHit[countXZ].SetMarkerColor(tckColor);
-
-                fXZHit[countXZ].SetMarkerSize(radius);
-                fXZHit[countXZ].SetMarkerStyle(20);
-                tckXZ++;
-                countXZ++;
+                if (xzTrack == nullptr) {
+                    xzTrack = GetDrawingGraph(fXZTrack, nTckXZ);
+                    drawLinesXZ.push_back(isTopLevel);
+                }
+                xzTrack->SetPoint(xzTrack->GetN(), x, z);
+                AddDrawingHit(xzHits[sizeStep], fXZHit, countXZ, hitsColor, sizeStep * markerSizeStep, x, z);
             }
 
             if (type == YZ) {
-                if (tckYZ == 0) nTckYZ++;
-                fYZTrack[nTckYZ - 1].SetPoint(tckYZ, y, z);
-                if (isTopLevel) drawLinesYZ[nTckYZ - 1] = 1;
-                fYZHit[countYZ].SetPoint(0, y, z);
-
-                if (!isTopLevel)
-                    fYZHit[countYZ].SetMarkerColor(level + 11);
-                else
-                    fYZHit[countYZ].SetMarkerColor(tckColor);
-
-                fYZHit[countYZ].SetMarkerSize(radius);
-                fYZHit[countYZ].SetMarkerStyle(20);
-                tckYZ++;
-                countYZ++;
+                if (yzTrack == nullptr) {
+                    yzTrack = GetDrawingGraph(fYZTrack, nTckYZ);
+                    drawLinesYZ.push_back(isTopLevel);
+                }
+                yzTrack->SetPoint(yzTrack->GetN(), y, z);
+                AddDrawingHit(yzHits[sizeStep], fYZHit, countYZ, hitsColor, sizeStep * markerSizeStep, y, z);
             }
 
             if (type % X == 0) {
@@ -823,6 +1257,13 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
                 if (z < minZ) minZ = z;
             }
         }
+
+        // If there is only one point the TGraph2D does NOT draw it!
+        for (auto& gr : xyzHits) {
+            if (gr.second->GetN() != 1) continue;
+            Double_t x = gr.second->GetX()[0], y = gr.second->GetY()[0], z = gr.second->GetZ()[0];
+            gr.second->SetPoint(1, x + 0.001, y + 0.001, z + 0.001);
+        }
     }
 
     fPad = new TPad(this->GetName(), " ", 0, 0, 1, 1);
@@ -835,86 +1276,53 @@ TPad* TRestTrackEvent::DrawEvent(const TString& option) {
     char title[256];
     sprintf(title, "Event ID %d", this->GetID());
 
-    TMultiGraph* mgXY = new TMultiGraph();
-    TMultiGraph* mgXZ = new TMultiGraph();
-    TMultiGraph* mgYZ = new TMultiGraph();
-
-    fPad->cd(1)->DrawFrame(minX - 10, minZ - 10, maxX + 10, maxZ + 10, title);
-    fPad->cd(2)->DrawFrame(minY - 10, minZ - 10, maxY + 10, maxZ + 10, title);
-
-    if (this->isXYZ()) fPad->cd(3)->DrawFrame(minX - 10, minY - 10, maxX + 10, maxY + 10, title);
+    TH1F* frameXZ = fPad->cd(1)->DrawFrame(minX - 10, minZ - 10, maxX + 10, maxZ + 10, title);
+    SetDrawingFrameStyle(frameXZ, "X-axis (mm)", "Z-axis (mm)");
+    for (size_t i = 0; i < countXZ; i++) fXZHit[i]->Draw("P");
 
-    for (int i = 0; i < countXZ; i++) mgXZ->Add(&fXZHit[i]);
-
-    fPad->cd(1);
-    mgXZ->GetXaxis()->SetTitle("X-axis (mm)");
-    mgXZ->GetYaxis()->SetTitle("Z-axis (mm)");
-    mgXZ->GetYaxis()->SetTitleOffset(1.75);
-    mgXZ->GetYaxis()->SetTitleSize(1.4 * mgXZ->GetYaxis()->GetTitleSize());
-    mgXZ->GetXaxis()->SetTitleSize(1.4 * mgXZ->GetXaxis()->GetTitleSize());
-    mgXZ->GetYaxis()->SetLabelSize(1.25 * mgXZ->GetYaxis()->GetLabelSize());
-    mgXZ->GetXaxis()->SetLabelSize(1.25 * mgXZ->GetXaxis()->GetLabelSize());
-    mgXZ->Draw("P");
-
-    for (int i = 0; i < countYZ; i++) mgYZ->Add(&fYZHit[i]);
-
-    fPad->cd(2);
-    mgYZ->GetXaxis()->SetTitle("Y-axis (mm)");
-    mgYZ->GetYaxis()->SetTitle("Z-axis (mm)");
-    mgYZ->GetYaxis()->SetTitleOffset(1.75);
-    mgYZ->GetYaxis()->SetTitleSize(1.4 * mgYZ->GetYaxis()->GetTitleSize());
-    mgYZ->GetXaxis()->SetTitleSize(1.4 * mgYZ->GetXaxis()->GetTitleSize());
-    mgYZ->GetYaxis()->SetLabelSize(1.25 * mgYZ->GetYaxis()->GetLabelSize());
-    mgYZ->GetXaxis()->SetLabelSize(1.25 * mgYZ->GetXaxis()->GetLabelSize());
-    mgYZ->Draw("P");
+    TH1F* frameYZ = fPad->cd(2)->DrawFrame(minY - 10, minZ - 10, maxY + 10, maxZ + 10, title);
+    SetDrawingFrameStyle(frameYZ, "Y-axis (mm)", "Z-axis (mm)");
+    for (size_t i = 0; i < countYZ; i++) fYZHit[i]->Draw("P");
 
     if (this->isXYZ()) {
-        for (int i = 0; i < countXY; i++) mgXY->Add(&fXYHit[i]);
-
-        fPad->cd(3);
-        mgXY->GetXaxis()->SetTitle("X-axis (mm)");
-        mgXY->GetYaxis()->SetTitle("Y-axis (mm)");
-        mgXY->GetYaxis()->SetTitleOffset(1.75);
-        mgXY->Draw("P");
-        mgXY->GetYaxis()->SetTitleSize(1.4 * mgXY->GetYaxis()->GetTitleSize());
-        mgXY->GetXaxis()->SetTitleSize(1.4 * mgXY->GetXaxis()->GetTitleSize());
-        mgXY->GetYaxis()->SetLabelSize(1.25 * mgXY->GetYaxis()->GetLabelSize());
-        mgXY->GetXaxis()->SetLabelSize(1.25 * mgXY->GetXaxis()->GetLabelSize());
+        TH1F* frameXY = fPad->cd(3)->DrawFrame(minX - 10, minY - 10, maxX + 10, maxY + 10, title);
+        SetDrawingFrameStyle(frameXY, "X-axis (mm)", "Y-axis (mm)");
+        for (size_t i = 0; i < countXY; i++) fXYHit[i]->Draw("P");
     }
 
-    for (int tck = 0; tck < nTckXZ; tck++) {
+    for (size_t tck = 0; tck < nTckXZ; tck++) {
         fPad->cd(1);
-        fXZTrack[tck].SetLineWidth(2.);
-        if (fXZTrack[tck].GetN() < 100 && drawLinesXZ[tck] == 1) fXZTrack[tck].Draw("L");
+        fXZTrack[tck]->SetLineWidth(2.);
+        if (fXZTrack[tck]->GetN() < 100 && drawLinesXZ[tck] == 1) fXZTrack[tck]->Draw("L");
     }
 
-    for (int tck = 0; tck < nTckYZ; tck++) {
+    for (size_t tck = 0; tck < nTckYZ; tck++) {
         fPad->cd(2);
-        fYZTrack[tck].SetLineWidth(2.);
-        if (fYZTrack[tck].GetN() < 100 && drawLinesYZ[tck] == 1) fYZTrack[tck].Draw("L");
+        fYZTrack[tck]->SetLineWidth(2.);
+        if (fYZTrack[tck]->GetN() < 100 && drawLinesYZ[tck] == 1) fYZTrack[tck]->Draw("L");
     }
 
     if (this->isXYZ()) {
-        for (int tck = 0; tck < nTckXY; tck++) {
+        for (size_t tck = 0; tck < nTckXY; tck++) {
             fPad->cd(3);
-            fXYTrack[tck].SetLineWidth(2.);
-            if (fXYTrack[tck].GetN() < 100 && drawLinesXY[tck] == 1) fXYTrack[tck].Draw("L");
+            fXYTrack[tck]->SetLineWidth(2.);
+            if (fXYTrack[tck]->GetN() < 100 && drawLinesXY[tck] == 1) fXYTrack[tck]->Draw("L");
         }
 
         fPad->cd(4);
 
         TString option = "P";
-        for (int tck = 0; tck < nTckXYZ; tck++) {
-            fXYZTrack[tck].SetLineWidth(2.);
-            if (fXZTrack[tck].GetN() < 100 && drawLinesXYZ[tck] == 1) {
-                fXYZTrack[tck].Draw("LINE");
+        for (size_t tck = 0; tck < nTckXYZ; tck++) {
+            fXYZTrack[tck]->SetLineWidth(2.);
+            if (fXYZTrack[tck]->GetN() < 100 && drawLinesXYZ[tck] == 1) {
+                fXYZTrack[tck]->Draw("LINE");
                 option = "same P";
             }
         }
 
-        for (int i = 0; i < countXYZ; i++) {
+        for (size_t i = 0; i < countXYZ; i++) {
             if (i > 0) option = "same P";
-            fXYZHit[i].Draw(option);
+            fXYZHit[i]->Draw(option);
         }
     }
 
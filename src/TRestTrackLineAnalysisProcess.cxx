@@ -36,6 +36,8 @@
 /// ### Parameters
 /// * **lineAnaMethod**: Method to evaluate the origin and end of the track, currently
 /// 3D method and default are implemented
+/// * **memoryFootprint**: If true, the memory taken by the input and output events is
+/// published in bytes as the observables inputMemoryFootprint and outputMemoryFootprint
 ///
 /// ### Observables
 /// * **trackBalanceXZ**: Track balance between the most energetic track and all tracks in the XZ projection
@@ -132,8 +134,7 @@ TRestEvent* TRestTrackLineAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     fTrackEvent = (TRestTrackEvent*)inputEvent;
 
     // Initialize outputTrackEvent
-    for (int t = 0; t < fTrackEvent->GetNumberOfTracks(); t++)
-        fOutTrackEvent->AddTrack(fTrackEvent->GetTrack(t));
+    fOutTrackEvent->AddTracks(fTrackEvent);
 
     TRestTrack* tckX = fTrackEvent->GetMaxEnergyTrackInX();
     TRestTrack* tckY = fTrackEvent->GetMaxEnergyTrackInY();
@@ -148,7 +149,7 @@ TRestEvent* TRestTrackLineAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     if (tckX && tckY) {
         // Retreive origin and end of the track for the XZ projection
         if (fLineAnaMethod == "3D") {
-            fTrackEvent->GetMaxTrackBoundaries3D(orig, end);
+            fTrackEvent->GetMaxTrackBoundaries3D(orig, end, nullptr);
         } else {
             if (fLineAnaMethod != "default") {
                 RESTWarning
@@ -180,7 +181,7 @@ TRestEvent* TRestTrackLineAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
         if (trackEnergyX > 0 && trackEnergyY > 0)
             trackBalance =
                 (trackEnergyX + trackEnergyY) / (fTrackEvent->GetEnergy("X") + fTrackEvent->GetEnergy("Y"));
-        relZ = fTrackEvent->GetMaxTrackRelativeZ();
+        relZ = fTrackEvent->GetMaxTrackRelativeZ(fZEnergy);
     }
 
     Double_t trackEnergy = trackEnergyX + trackEnergyY;
@@ -214,6 +215,9 @@ TRestEvent* TRestTrackLineAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     fOutTrackEvent->AddTrack(tckY);
 
     fOutTrackEvent->SetLevels();
+
+    if (fMemoryFootprint) TRestTrackEvent::SetMemoryFootprintObservables(this, fTrackEvent, fOutTrackEvent);
+
     return fOutTrackEvent;
 }
 
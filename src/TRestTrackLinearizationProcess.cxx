@@ -36,6 +36,10 @@
 ///
 /// ### Parameters
 /// * fMaxNodes : Maximum number of nodes (hits) to reduce the hits to a line
+/// * fTrackThreads : Number of threads linearizing the tracks of an event, one per
+/// core if 0. The output does not depend on it.
+/// * fMemoryFootprint : If true, the memory taken by the input and output events is
+/// published in bytes as the observables inputMemoryFootprint and outputMemoryFootprint
 ///
 /// ### Examples
 /// \code
@@ -62,6 +66,8 @@
 
 #include "TRestTrackLinearizationProcess.h"
 
+#include <mutex>
+
 #include "TRestTrackReductionProcess.h"
 
 using namespace std;
@@ -101,28 +107,34 @@ void TRestTrackLinearizationProcess::InitProcess() {}
 TRestEvent* TRestTrackLinearizationProcess::ProcessEvent(TRestEvent* inputEvent) {
     fTrackEvent = (TRestTrackEvent*)inputEvent;
 
+    fOutTrackEvent->AddTracks(fTrackEvent);
+
+    std::vector<Int_t> tracks;
     for (int t = 0; t < fTrackEvent->GetNumberOfTracks(); t++)
-        fOutTrackEvent->AddTrack(fTrackEvent->GetTrack(t));
+        if (fTrackEvent->GetLevel(t) <= 1) tracks.push_back(t);
+
+    const Int_t firstNewTrack = fOutTrackEvent->GetNumberOfTracks();
 
-    for (int t = 0; t < fTrackEvent->GetNumberOfTracks(); t++) {
-        if (fTrackEvent->GetLevel(t) > 1) continue;
-        TRestTrack* track = fTrackEvent->GetTrack(t);
-        TRestVolumeHits* hits = track->GetVolumeHits();
+    auto solve = [&](Int_t t, std::vector<TRestVolumeHits>& newTracks) {
+        TRestVolumeHits* hits = fTrackEvent->GetTrack(t)->GetVolumeHits();
         TRestVolumeHits vHits;
         // Perform track linearization
         GetHitsProjection(hits, fMaxNodes, vHits);
-        if (vHits.GetNumberOfHits() == 0) continue;
+        if (vHits.GetNumberOfHits() == 0) return true;
 
         RESTDebug << "Adding track " << RESTendl;
         // Store tracks after tinearization
-        TRestTrack newTrack;
-        newTrack.SetTrackID(fOutTrackEvent->GetNumberOfTracks() + 1);
-        newTrack.SetParentID(track->GetTrackID());
-        newTrack.SetVolumeHits(vHits);
+        newTracks.emplace_back(std::move(vHits));
+        return true;
+    };
 
-        RESTDebug << "Is XZ " << newTrack.isXZ() << " Is YZ " << newTrack.isYZ() << RESTendl;
+    const Int_t nThreads =
+        GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug ? 1 : fTrackThreads;
+    fOutTrackEvent->EmplaceSolvedTracks(fTrackEvent, tracks, solve, nThreads);
 
-        fOutTrackEvent->AddTrack(&newTrack);
+    for (int t = firstNewTrack; t < fOutTrackEvent->GetNumberOfTracks(); t++) {
+        TRestTrack* newTrack = fOutTrackEvent->GetTrack(t);
+        RESTDebug << "Is XZ " << newTrack->isXZ() << " Is YZ " << newTrack->isYZ() << RESTendl;
     }
 
     RESTDebug << "NTracks  X " << fOutTrackEvent->GetNumberOfTracks("X") << " Y "
@@ -130,6 +142,9 @@ TRestEvent* TRestTrackLinearizationProcess::ProcessEvent(TRestEvent* inputEvent)
               << RESTendl;
 
     fOutTrackEvent->SetLevels();
+
+    if (fMemoryFootprint) TRestTrackEvent::SetMemoryFootprintObservables(this, fTrackEvent, fOutTrackEvent);
+
     return fOutTrackEvent;
 }
 
@@ -197,6 +212,12 @@ std::vector<std::pair<double, double>> TRestTrackLinearizationProcess::GetBestNo
     RESTDebug << "Max " << max[0] << " " << max[1] << RESTendl;
     RESTDebug << "Min " << min[0] << " " << min[1] << RESTendl;
 
+    // TF1 registers itself in the global list of functions of ROOT, the graphs keep
+    // the fitted function and the fitter is shared, so the graphs of the tracks solved
+    // on different threads are built, fitted and destroyed in turn
+    static std::mutex fitMutex;
+    std::lock_guard<std::mutex> lock(fitMutex);
+
     TGraph gr[2];
 
     const int hitAvg = std::round(totEn / (double)nHits / 10.);
@@ -10,10 +10,521 @@
 
 #include "TRestTrackPathMinimizationProcess.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <queue>
+
 using namespace std;
 
 ClassImp(TRestTrackPathMinimizationProcess);
 
+namespace {
+typedef std::array<double, 3> Point;
+
+// Position of the hits, with the coordinates not measured by a hit set to zero
+std::vector<Point> GetHitsPoints(TRestVolumeHits* hits) {
+    const int nHits = hits->GetNumberOfHits();
+    std::vector<Point> points(nHits);
+    for (int i = 0; i < nHits; i++) {
+        const REST_HitType type = hits->GetType(i);
+        points[i] = {type % X == 0 ? hits->GetX(i) : 0., type % Y == 0 ? hits->GetY(i) : 0.,
+                     type % Z == 0 ? hits->GetZ(i) : 0.};
+    }
+    return points;
+}
+
+double GetDistance2(const Point& a, const Point& b) {
+    const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Static kd-tree over a set of points. Each node of the tree is the median point of
+// a range of fIndex, split along the axis of largest spread. Points can be removed
+// from the closest point queries, fCount keeping the points left in each subtree.
+class KdTree {
+   public:
+    explicit KdTree(const std::vector<Point>& points)
+        : fPoints(points),
+          fIndex(points.size()),
+          fAxis(points.size(), 0),
+          fPosition(points.size()),
+          fCount(points.size()),
+          fRemoved(points.size(), 0) {
+        std::iota(fIndex.begin(), fIndex.end(), 0);
+        Build(0, fIndex.size());
+        for (size_t i = 0; i < fIndex.size(); i++) fPosition[fIndex[i]] = i;
+        fSize = fCount;
+    }
+
+    // Removes the point n from GetClosest
+    void Remove(int n) {
+        if (fRemoved[n]) return;
+        fRemoved[n] = 1;
+        size_t lo = 0, hi = fIndex.size();
+        const size_t pos = fPosition[n];
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            fCount[mid]--;
+            if (pos == mid) break;
+            if (pos < mid)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+    }
+
+    // Brings back all the removed points
+    void Reset() {
+        fCount = fSize;
+        std::fill(fRemoved.begin(), fRemoved.end(), 0);
+    }
+
+    // The point closest to the point n that has not been removed, or -1 if there is none
+    int GetClosest(int n) const {
+        std::pair<double, int> closest(std::numeric_limits<double>::infinity(), -1);
+        SearchClosest(0, fIndex.size(), n, closest);
+        return closest.second;
+    }
+
+    // The k points closest to the point n, excluding itself, sorted by distance
+    std::vector<int> GetNeighbours(int n, int k) const {
+        std::priority_queue<std::pair<double, int> > closest;
+        Search(0, fIndex.size(), n, k, closest);
+
+        std::vector<int> neighbours(closest.size());
+        for (int i = neighbours.size() - 1; i >= 0; i--) {
+            neighbours[i] = closest.top().second;
+            closest.pop();
+        }
+        return neighbours;
+    }
+
+   private:
+    const std::vector<Point>& fPoints;
+    std::vector<int> fIndex;
+    std::vector<int> fAxis;
+    std::vector<size_t> fPosition;
+    std::vector<int> fCount;
+    std::vector<int> fSize;
+    std::vector<char> fRemoved;
+
+    void Build(size_t lo, size_t hi) {
+        if (hi > lo) fCount[(lo + hi) / 2] = hi - lo;
+        if (hi - lo <= 1) return;
+
+        Point min = fPoints[fIndex[lo]], max = min;
+        for (size_t i = lo + 1; i < hi; i++)
+            for (int a = 0; a < 3; a++) {
+                min[a] = std::min(min[a], fPoints[fIndex[i]][a]);
+                max[a] = std::max(max[a], fPoints[fIndex[i]][a]);
+            }
+        int axis = 0;
+        for (int a = 1; a < 3; a++)
+            if (max[a] - min[a] > max[axis] - min[axis]) axis = a;
+
+        const size_t mid = (lo + hi) / 2;
+        std::nth_element(fIndex.begin() + lo, fIndex.begin() + mid, fIndex.begin() + hi,
+                         [&](int i, int j) { return fPoints[i][axis] < fPoints[j][axis]; });
+        fAxis[mid] = axis;
+
+        Build(lo, mid);
+        Build(mid + 1, hi);
+    }
+
+    void Search(size_t lo, size_t hi, int n, int k,
+                std::priority_queue<std::pair<double, int> >& closest) const {
+        if (lo >= hi) return;
+
+        const size_t mid = (lo + hi) / 2;
+        const int node = fIndex[mid];
+        if (node != n) {
+            const double d2 = GetDistance2(fPoints[n], fPoints[node]);
+            if ((int)closest.size() < k) {
+                closest.emplace(d2, node);
+            } else if (d2 < closest.top().first) {
+                closest.pop();
+                closest.emplace(d2, node);
+            }
+        }
+        if (hi - lo == 1) return;
+
+        const double diff = fPoints[n][fAxis[mid]] - fPoints[node][fAxis[mid]];
+        const bool lowFirst = diff < 0;
+        Search(lowFirst ? lo : mid + 1, lowFirst ? mid : hi, n, k, closest);
+        if ((int)closest.size() < k || diff * diff < closest.top().first)
+            Search(lowFirst ? mid + 1 : lo, lowFirst ? hi : mid, n, k, closest);
+    }
+
+    void SearchClosest(size_t lo, size_t hi, int n, std::pair<double, int>& closest) const {
+        if (lo >= hi) return;
+        const size_t mid = (lo + hi) / 2;
+        if (fCount[mid] == 0) return;
+
+        const int node = fIndex[mid];
+        if (node != n && !fRemoved[node]) {
+            const double d2 = GetDistance2(fPoints[n], fPoints[node]);
+            if (d2 < closest.first) closest = {d2, node};
+        }
+        if (hi - lo == 1) return;
+
+        const double diff = fPoints[n][fAxis[mid]] - fPoints[node][fAxis[mid]];
+        const bool lowFirst = diff < 0;
+        SearchClosest(lowFirst ? lo : mid + 1, lowFirst ? mid : hi, n, closest);
+        if (diff * diff < closest.first)
+            SearchClosest(lowFirst ? mid + 1 : lo, lowFirst ? hi : mid, n, closest);
+    }
+};
+
+// Order of the points along a Morton (Z-order) space filling curve
+std::vector<int> GetSpaceFillingCurveOrder(const std::vector<Point>& points) {
+    const int nPoints = points.size();
+    std::vector<int> order(nPoints);
+    std::iota(order.begin(), order.end(), 0);
+    if (nPoints == 0) return order;
+
+    Point min = points[0];
+    double extent = 0;
+    for (const auto& p : points)
+        for (int a = 0; a < 3; a++) min[a] = std::min(min[a], p[a]);
+    for (const auto& p : points)
+        for (int a = 0; a < 3; a++) extent = std::max(extent, p[a] - min[a]);
+
+    const uint64_t cells = (1 << 21) - 1;
+    std::vector<uint64_t> key(nPoints, 0);
+    for (int i = 0; i < nPoints; i++) {
+        for (int a = 0; a < 3; a++) {
+            const uint64_t cell = extent > 0 ? (uint64_t)((points[i][a] - min[a]) / extent * cells) : 0;
+            for (int bit = 0; bit < 21; bit++) key[i] |= ((cell >> bit) & 1) << (3 * bit + a);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](int i, int j) { return key[i] < key[j]; });
+    return order;
+}
+
+// Local search on the path of the given points, using 2-opt and Or-opt moves towards
+// the neighbours of each point. It keeps a queue of points whose surroundings changed,
+// so that the work is proportional to the number of improvements. An open path is
+// handled as a tour through an extra point at zero distance from all the others.
+void ImprovePath(const std::vector<Point>& points, const std::vector<std::vector<int> >& neighbours,
+                 std::vector<int>& path, bool cyclic) {
+    const int nPoints = points.size();
+    const int nNodes = cyclic ? nPoints : nPoints + 1;
+    if (nPoints < 4) return;
+
+    const int dummy = nPoints;
+    std::vector<int> tour(path);
+    if (!cyclic) tour.push_back(dummy);
+    std::vector<int> pos(nNodes);
+    for (int i = 0; i < nNodes; i++) pos[tour[i]] = i;
+
+    auto dist = [&](int a, int b) {
+        if (a == dummy || b == dummy) return 0.;
+        return std::sqrt(GetDistance2(points[a], points[b]));
+    };
+    auto next = [&](int a) { return tour[(pos[a] + 1) % nNodes]; };
+    auto prev = [&](int a) { return tour[(pos[a] + nNodes - 1) % nNodes]; };
+
+    // It reverses the tour between the positions i and j, or the rest of the tour,
+    // which gives the same cycle, when it is shorter
+    auto reverse = [&](int i, int j) {
+        int len = (j - i + nNodes) % nNodes + 1;
+        if (2 * len > nNodes) {
+            const int k = i;
+            i = (j + 1) % nNodes;
+            j = (k + nNodes - 1) % nNodes;
+            len = nNodes - len;
+        }
+        for (int s = 0; s < len / 2; s++) {
+            std::swap(tour[i], tour[j]);
+            pos[tour[i]] = i;
+            pos[tour[j]] = j;
+            i = (i + 1) % nNodes;
+            j = (j + nNodes - 1) % nNodes;
+        }
+    };
+
+    const double epsilon = 1e-9;
+    std::vector<char> queued(nPoints, 1);
+    std::deque<int> queue(path.begin(), path.end());
+    auto push = [&](int a) {
+        if (a != dummy && !queued[a]) {
+            queued[a] = 1;
+            queue.push_back(a);
+        }
+    };
+
+    // 2-opt move replacing the edges (a, succ a) and (c, succ c) by (a, c) and
+    // (succ a, succ c), or the same with the predecessors
+    auto twoOpt = [&](int a) {
+        for (int dir = 0; dir < 2; dir++) {
+            const int b = dir == 0 ? next(a) : prev(a);
+            const double dab = dist(a, b);
+            for (int c : neighbours[a]) {
+                const double g1 = dab - dist(a, c);
+                if (g1 <= epsilon) break;
+                const int d = dir == 0 ? next(c) : prev(c);
+                if (c == b || d == a) continue;
+                if (g1 + dist(c, d) - dist(b, d) <= epsilon) continue;
+
+                if (dir == 0)
+                    reverse(pos[b], pos[c]);
+                else
+                    reverse(pos[a], pos[d]);
+                for (int v : {a, b, c, d}) push(v);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // It reverses the path between the points u and v, where w is the point next to u
+    // outside of the path
+    auto reversePath = [&](int u, int v, int w) {
+        if (prev(u) == w)
+            reverse(pos[u], pos[v]);
+        else
+            reverse(pos[v], pos[u]);
+    };
+
+    // Or-opt move of the segment of up to three points starting at a, inserted between
+    // a neighbour c of one of its ends and the point e before or after c. The move is
+    // done with three reversals, the last one only when the segment keeps its direction.
+    auto orOpt = [&](int a) {
+        int segment[3];
+        for (int len = 1; len <= 3; len++) {
+            for (int dir = 0; dir < 2; dir++) {
+                segment[0] = a;
+                for (int s = 1; s < len; s++)
+                    segment[s] = dir == 0 ? next(segment[s - 1]) : prev(segment[s - 1]);
+                const int s1 = segment[0], s2 = segment[len - 1];
+                if (std::find(segment, segment + len, dummy) != segment + len) break;
+                const int p = dir == 0 ? prev(s1) : next(s1);
+                const int n = dir == 0 ? next(s2) : prev(s2);
+                if (p == s2 || n == s1 || p == n) break;
+                const double removal = dist(p, s1) + dist(s2, n) - dist(p, n);
+                if (removal <= epsilon) continue;
+
+                // First and last points of the segment following the tour, and their outer neighbours
+                const int first = dir == 0 ? s1 : s2, last = dir == 0 ? s2 : s1;
+                const int before = prev(first), after = next(last);
+
+                for (int end = 0; end < 2; end++) {
+                    const int sc = end == 0 ? s1 : s2, se = end == 0 ? s2 : s1;
+                    for (int c : neighbours[sc]) {
+                        if (std::find(segment, segment + len, c) != segment + len) continue;
+                        if (dist(c, sc) >= removal) break;
+
+                        for (int side = 0; side < 2; side++) {
+                            const int e = side == 0 ? next(c) : prev(c);
+                            if (e == s1 || e == s2) continue;
+                            if (removal - (dist(c, sc) + dist(se, e) - dist(c, e)) <= epsilon) continue;
+
+                            // Insertion between u and v = next(u), with the point touching u
+                            const int u = side == 0 ? c : e;
+                            const int touchingU = side == 0 ? sc : se;
+
+                            reverse(pos[first], pos[u]);
+                            if (u != after) reversePath(u, after, before);
+                            if (touchingU == first) reversePath(last, first, u);
+
+                            for (int w : {p, n, c, e}) push(w);
+                            for (int s = 0; s < len; s++) push(segment[s]);
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    while (!queue.empty()) {
+        const int a = queue.front();
+        queue.pop_front();
+        queued[a] = 0;
+        if (twoOpt(a) || orOpt(a)) push(a);
+    }
+
+    // The path starts after the extra point of an open path
+    const int first = cyclic ? 0 : (pos[dummy] + 1) % nNodes;
+    for (int i = 0; i < nPoints; i++) path[i] = tour[(first + i) % nNodes];
+}
+
+// Depth first branch and bound over the paths through a set of points. A partial
+// path is dropped when its length plus a lower bound of the rest of the path is not
+// shorter than the best path found so far. The bound is the minimum spanning tree of
+// the points left plus their closest edges to the end of the partial path and, for a
+// cyclic path, to its start.
+class PathBranchAndBound {
+   public:
+    PathBranchAndBound(const std::vector<std::vector<double> >& dist, bool cyclic)
+        : fDist(dist), fN(dist.size()), fCyclic(cyclic), fVisited(fN), fKey(fN), fOrder(fN) {
+        // Children are tried closest first
+        for (int i = 0; i < fN; i++) {
+            fOrder[i].resize(fN);
+            std::iota(fOrder[i].begin(), fOrder[i].end(), 0);
+            std::sort(fOrder[i].begin(), fOrder[i].end(),
+                      [&](int a, int b) { return fDist[i][a] < fDist[i][b]; });
+        }
+    }
+
+    // Returns the length of the shortest path, which is written to path
+    double Solve(std::vector<int>& path) {
+        Seed();
+        // Any hit can start a cyclic path
+        const int nStarts = fCyclic ? 1 : fN;
+        for (int s = 0; s < nStarts; s++) {
+            fPath.assign(1, s);
+            fVisited[s] = 1;
+            Search(0);
+            fVisited[s] = 0;
+        }
+        path = fBestPath;
+        return fBest;
+    }
+
+   private:
+    const std::vector<std::vector<double> >& fDist;
+    const int fN;
+    const bool fCyclic;
+    std::vector<char> fVisited;
+    std::vector<double> fKey;
+    std::vector<std::vector<int> > fOrder;
+    std::vector<int> fPath;
+    std::vector<int> fBestPath;
+    std::vector<int> fAdded;
+    double fBest = std::numeric_limits<double>::infinity();
+
+    // The best nearest neighbour path over all the starting hits is the first incumbent
+    void Seed() {
+        for (int s = 0; s < fN; s++) {
+            fPath.assign(1, s);
+            fVisited.assign(fN, 0);
+            fVisited[s] = 1;
+            double length = 0;
+            while ((int)fPath.size() < fN) {
+                const int end = fPath.back();
+                for (const int next : fOrder[end]) {
+                    if (fVisited[next]) continue;
+                    length += fDist[end][next];
+                    fVisited[next] = 1;
+                    fPath.push_back(next);
+                    break;
+                }
+            }
+            if (fCyclic) length += fDist[fPath.back()][s];
+            if (length < fBest) {
+                fBest = length;
+                fBestPath = fPath;
+            }
+        }
+        fVisited.assign(fN, 0);
+        ImproveSeed();
+    }
+
+    // 2-opt moves on the incumbent, including the reversal of its ends on an open path
+    void ImproveSeed() {
+        std::vector<int>& p = fBestPath;
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (int i = 0; i < fN - 1; i++)
+                for (int j = i + 1; j < fN; j++) {
+                    // Reverse p[i..j], replacing the edges (p[i-1], p[i]) and (p[j], p[j+1])
+                    const bool hasPrev = i > 0 || fCyclic;
+                    const bool hasNext = j < fN - 1 || fCyclic;
+                    const int prev = p[(i + fN - 1) % fN], next = p[(j + 1) % fN];
+                    if (hasPrev && hasNext && prev == p[j]) continue;
+                    double delta = 0;
+                    if (hasPrev) delta += fDist[prev][p[j]] - fDist[prev][p[i]];
+                    if (hasNext) delta += fDist[p[i]][next] - fDist[p[j]][next];
+                    if (delta < -1e-9) {
+                        std::reverse(p.begin() + i, p.begin() + j + 1);
+                        improved = true;
+                    }
+                }
+        }
+
+        fBest = fCyclic ? fDist[p[fN - 1]][p[0]] : 0;
+        for (int i = 1; i < fN; i++) fBest += fDist[p[i - 1]][p[i]];
+    }
+
+    // Lower bound of the rest of the path, or any value not below cutoff if it reaches it
+    double GetLowerBound(double cutoff) {
+        const int end = fPath.back(), start = fPath[0];
+
+        // The rest of the path joins the end to the points left, and for a cyclic path
+        // these to the start. Each cyclic path is only searched in the direction where
+        // it closes at a point above the second one.
+        double toEnd = std::numeric_limits<double>::infinity(), toStart = toEnd;
+        int first = -1;
+        for (int i = 0; i < fN; i++) {
+            if (fVisited[i]) continue;
+            toEnd = std::min(toEnd, fDist[end][i]);
+            if (fCyclic && (fPath.size() < 2 || i > fPath[1])) toStart = std::min(toStart, fDist[start][i]);
+            if (first < 0) first = i;
+        }
+        double bound = fCyclic ? toEnd + toStart : toEnd;
+
+        // Prim's algorithm over the points left, fKey of the points out of the tree
+        std::vector<char>& inTree = fVisited;
+        fAdded.assign(1, first);
+        inTree[first] = 1;
+        int left = 0;
+        for (int i = 0; i < fN; i++)
+            if (!inTree[i]) {
+                fKey[i] = fDist[first][i];
+                left++;
+            }
+        while (left > 0 && bound < cutoff) {
+            int next = -1;
+            for (int i = 0; i < fN; i++)
+                if (!inTree[i] && (next < 0 || fKey[i] < fKey[next])) next = i;
+            bound += fKey[next];
+            inTree[next] = 1;
+            fAdded.push_back(next);
+            left--;
+            for (int i = 0; i < fN; i++)
+                if (!inTree[i]) fKey[i] = std::min(fKey[i], fDist[next][i]);
+        }
+        for (const int i : fAdded) inTree[i] = 0;
+        return bound;
+    }
+
+    void Search(double length) {
+        const int end = fPath.back();
+        if ((int)fPath.size() == fN) {
+            if (fCyclic && end < fPath[1]) return;
+            if (fCyclic) length += fDist[end][fPath[0]];
+            if (length < fBest) {
+                fBest = length;
+                fBestPath = fPath;
+            }
+            return;
+        }
+
+        if (length + GetLowerBound(fBest - length) >= fBest) return;
+
+        for (const int next : fOrder[end]) {
+            if (fVisited[next]) continue;
+            const double nextLength = length + fDist[end][next];
+            if (nextLength >= fBest) break;
+            fVisited[next] = 1;
+            fPath.push_back(next);
+            Search(nextLength);
+            fPath.pop_back();
+            fVisited[next] = 0;
+        }
+    }
+};
+}  // namespace
+
 TRestTrackPathMinimizationProcess::TRestTrackPathMinimizationProcess() { Initialize(); }
 
 TRestTrackPathMinimizationProcess::~TRestTrackPathMinimizationProcess() { delete fOutputTrackEvent; }
@@ -26,7 +537,18 @@ void TRestTrackPathMinimizationProcess::Initialize() {
     fOutputTrackEvent = new TRestTrackEvent();
 }
 
-void TRestTrackPathMinimizationProcess::InitProcess() {}
+///////////////////////////////////////////////
+/// \brief The dp method allocates 2^n*n doubles per track and thread, so fMaxDPNodes
+/// is limited to 20 hits, i.e. about 170 MB.
+///
+void TRestTrackPathMinimizationProcess::InitProcess() {
+    const Int_t maxDPNodes = 20;
+    if (fMaxDPNodes > maxDPNodes) {
+        RESTWarning << "TRestTrackPathMinimizationProcess: maxDPNodes " << fMaxDPNodes
+                    << " is too large, using " << maxDPNodes << RESTendl;
+        fMaxDPNodes = maxDPNodes;
+    }
+}
 
 TRestEvent* TRestTrackPathMinimizationProcess::ProcessEvent(TRestEvent* inputEvent) {
     fInputTrackEvent = (TRestTrackEvent*)inputEvent;
@@ -36,11 +558,12 @@ TRestEvent* TRestTrackPathMinimizationProcess::ProcessEvent(TRestEvent* inputEve
              << fInputTrackEvent->GetNumberOfTracks() << endl;
 
     // Copying the input tracks to the output track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++)
-        fOutputTrackEvent->AddTrack(fInputTrackEvent->GetTrack(tck));
+    fOutputTrackEvent->AddTracks(fInputTrackEvent);
+
+    const auto eventStart = std::chrono::steady_clock::now();
+    std::vector<char> suboptimal(fInputTrackEvent->GetNumberOfTracks(), 0);
 
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++) {
-        if (!fInputTrackEvent->isTopLevel(tck)) continue;
+    auto solve = [&](Int_t tck, std::vector<TRestVolumeHits>& tracks) {
         Int_t tckId = fInputTrackEvent->GetTrack(tck)->GetTrackID();
 
         TRestVolumeHits* hits = fInputTrackEvent->GetTrack(tck)->GetVolumeHits();
@@ -61,90 +584,90 @@ TRestEvent* TRestTrackPathMinimizationProcess::ProcessEvent(TRestEvent* inputEve
         std::vector<int> bestPath(nHits);
         for (int i = 0; i < nHits; i++) bestPath[i] = i;  // Initialize
 
+        Int_t rval = 0;
         if (fMinMethod == "bruteforce")
             BruteForce(hits, bestPath);
         else if (fMinMethod == "closestN")
             NearestNeighbour(hits, bestPath);
-        else
-            HeldKarp(hits, bestPath);  // default
-
-        TRestVolumeHits bestHitsOrder;
-        for (const auto& v : bestPath) bestHitsOrder.AddHit(*hits, v);
+        else if (fMinMethod == "linkern")
+            LocalSearch(hits, bestPath);
+        else if (fMinMethod == "dp" && nHits <= fMaxDPNodes)
+            DynamicProgramming(hits, bestPath);
+        else {
+            // The track budget, cut to what is left of the event budget
+            Double_t timeBudget = fTrackTimeBudget;
+            if (fEventTimeBudget >= 0) {
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - eventStart;
+                const Double_t left = std::max(0., fEventTimeBudget - elapsed.count());
+                timeBudget = timeBudget < 0 ? left : std::min(timeBudget, left);
+            }
+            rval = HeldKarp(hits, bestPath, timeBudget);  // default
+            suboptimal[tck] = rval == HELDKARP_SEARCHLIMITEXCEEDED;
+        }
 
         // TODO We must also copy other track info here
-        TRestTrack bestTrack;
-        bestTrack.SetTrackID(fOutputTrackEvent->GetNumberOfTracks() + 1);
-        bestTrack.SetParentID(tckId);
-        bestTrack.SetVolumeHits(bestHitsOrder);
-        fOutputTrackEvent->AddTrack(&bestTrack);
-    }
+        tracks.emplace_back();
+        for (const auto& v : bestPath) tracks.back().AddHit(*hits, v);
+
+        return rval != HELDKARP_ERROR;
+    };
+
+    const Int_t nThreads =
+        GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug ? 1 : fTrackThreads;
+    const std::vector<Int_t>& topLevelTracks = fInputTrackEvent->GetTopLevelTracks();
+    if (!fOutputTrackEvent->EmplaceSolvedTracks(fInputTrackEvent, topLevelTracks, solve, nThreads))
+        fOutputTrackEvent->SetOK(false);
+    const Int_t suboptimalTracks = std::count(suboptimal.begin(), suboptimal.end(), 1);
 
     fOutputTrackEvent->SetLevels();
+
+    SetObservableValue("suboptimalTracks", suboptimalTracks);
+
+    if (fMemoryFootprint)
+        TRestTrackEvent::SetMemoryFootprintObservables(this, fInputTrackEvent, fOutputTrackEvent);
+
     return fOutputTrackEvent;
 }
 
 ///////////////////////////////////////////////
 /// \brief Return the index with the shortest path solving Travelling Salesman Problem (TSP) using
-/// nearest neighbour algorithm, complexity is n2*n, it doesn't guarantee that the minimum
-/// path is reached, but the solution should be within 25% of the distance to the minimum path
+/// nearest neighbour algorithm, it doesn't guarantee that the minimum path is reached, but the
+/// solution should be within 25% of the distance to the minimum path. The closest hits are
+/// found with a kd-tree, and the path is built from at most fMaxStarts starting hits spread
+/// along a space filling curve, so it scales almost linearly with the number of hits. The
+/// best path is then improved with 2-opt and Or-opt moves as in LocalSearch.
 ///
 void TRestTrackPathMinimizationProcess::NearestNeighbour(TRestVolumeHits* hits, std::vector<int>& bestPath) {
     const int nHits = hits->GetNumberOfHits();
-    vector<vector<double>> dist(nHits, vector<double>(nHits));
     RESTDebug << "Nhits " << nHits << RESTendl;
 
     if (nHits < 3) return;
 
-    for (int i = 0; i < nHits; i++) {
-        for (int j = i; j < nHits; j++) {
-            if (i == j) {
-                dist[i][j] = 0;  // Distance within the same vertex
-            } else {
-                dist[i][j] = hits->GetDistance(i, j);  // Distance within two hits vertex
-                dist[j][i] = dist[i][j];               // It is symmetric
-            }
-        }
-    }
+    const std::vector<Point> points = GetHitsPoints(hits);
+    KdTree tree(points);
+    const std::vector<int> curve = GetSpaceFillingCurveOrder(points);
 
-    double min_path = 1E9;
+    double min_path = std::numeric_limits<double>::infinity();
     std::vector<int> current_path(nHits);
 
-    // Find the shortest path starting from all vertex
-    for (int s = 0; s < nHits; s++) {
-        std::vector<int> vertex(nHits - 1);
+    // The ends of the curve are always tried, as they are good starts for an open path
+    const int nStarts = std::max(1, std::min(fMaxStarts, nHits));
+    for (int n = 0; n < nStarts; n++) {
+        const int s = nStarts == 1 ? curve[0] : curve[(size_t)n * (nHits - 1) / (nStarts - 1)];
 
-        int j = 0;
-        for (int i = 0; i < nHits; i++) {
-            if (i == s) continue;
-            vertex[j] = i;
-            j++;
-        }
-
-        // store current Path weight(cost)
-        double current_pathweight = 0;
+        tree.Reset();
+        tree.Remove(s);
         current_path[0] = s;
 
-        // compute current path weight
+        double current_pathweight = 0;
         int k = s;
-        while (!vertex.empty()) {
-            int closestN = 0;
-            int index = 0, bestIndex = 0;
-            double minDist = 1E9;
-            for (const auto& v : vertex) {
-                const double d = dist[k][v];
-                if (d < minDist) {
-                    minDist = d;
-                    current_pathweight += d;
-                    closestN = v;
-                    bestIndex = index;
-                }
-                index++;
-            }
-            k = closestN;
-            current_path[nHits - vertex.size()] = k;
-            vertex.erase(vertex.begin() + bestIndex);
+        for (int i = 1; i < nHits && current_pathweight < min_path; i++) {
+            const int closestN = tree.GetClosest(k);
+            current_pathweight += std::sqrt(GetDistance2(points[k], points[closestN]));
+            tree.Remove(closestN);
+            current_path[i] = k = closestN;
         }
-        if (fCyclic) current_pathweight += dist[k][s];
+        if (fCyclic) current_pathweight += std::sqrt(GetDistance2(points[k], points[s]));
 
         if (current_pathweight < min_path) {
             min_path = current_pathweight;
@@ -152,6 +675,126 @@ void TRestTrackPathMinimizationProcess::NearestNeighbour(TRestVolumeHits* hits,
         }
     }
 
+    if (nHits >= 4) {
+        const int nNeighbours = 10;
+        std::vector<std::vector<int> > neighbours(nHits);
+        for (int i = 0; i < nHits; i++) neighbours[i] = tree.GetNeighbours(i, nNeighbours);
+        ImprovePath(points, neighbours, bestPath, fCyclic);
+    }
+
+    if (this->GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
+        cout << "Min path ";
+        for (const auto& v : bestPath) cout << v << " ";
+        cout << endl;
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Return the index with a short path through the hits, for tracks with more
+/// hits than the exact methods can handle. The hits are first ordered along a space
+/// filling curve, and the path is then improved with 2-opt and Or-opt moves, the
+/// simplest moves of the Lin-Kernighan heuristic, restricted to the closest hits of
+/// each hit as found with a kd-tree. It doesn't guarantee the minimum path, but it
+/// scales almost linearly with the number of hits.
+///
+void TRestTrackPathMinimizationProcess::LocalSearch(TRestVolumeHits* hits, std::vector<int>& bestPath) {
+    const int nHits = hits->GetNumberOfHits();
+    RESTDebug << "Nhits " << nHits << RESTendl;
+
+    if (nHits < 4) return;
+
+    const int nNeighbours = 10;
+    const std::vector<Point> points = GetHitsPoints(hits);
+    const KdTree tree(points);
+    std::vector<std::vector<int> > neighbours(nHits);
+    for (int i = 0; i < nHits; i++) neighbours[i] = tree.GetNeighbours(i, nNeighbours);
+
+    bestPath = GetSpaceFillingCurveOrder(points);
+    ImprovePath(points, neighbours, bestPath, fCyclic);
+
+    if (this->GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
+        cout << "Min path ";
+        for (const auto& v : bestPath) cout << v << " ";
+        cout << endl;
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Return the index with the shortest path using the Held-Karp dynamic
+/// programming over subsets of hits, complexity is 2^n*n^2 and the minimum path is
+/// guarantee. It is faster than the other exact methods for small tracks, but the
+/// memory grows as 2^n*n, so tracks with more than fMaxDPNodes hits are minimized
+/// with HeldKarp instead.
+///
+void TRestTrackPathMinimizationProcess::DynamicProgramming(TRestVolumeHits* hits,
+                                                           std::vector<int>& bestPath) {
+    const int nHits = hits->GetNumberOfHits();
+    RESTDebug << "Nhits " << nHits << RESTendl;
+
+    if (nHits < 3) return;
+
+    // A cyclic path starts at the last hit, which is left out of the subsets
+    const int n = fCyclic ? nHits - 1 : nHits;
+    const int width = (n + 3) & ~3;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // Rows padded to a multiple of 4 so that the inner loop runs over whole vector lanes
+    std::vector<double> dist(n * width, inf);
+    std::vector<double> toLast(n, 0);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < i; j++) dist[i * width + j] = dist[j * width + i] = hits->GetDistance(i, j);
+        if (fCyclic) toLast[i] = hits->GetDistance(i, nHits - 1);
+    }
+
+    // cost[mask * width + j] is the length of the shortest path through the hits in mask ending at j
+    const size_t nMasks = (size_t)1 << n;
+    std::vector<double> cost(nMasks * width, inf);
+    for (int j = 0; j < n; j++) cost[((size_t)1 << j) * width + j] = toLast[j];
+
+    for (size_t mask = 1; mask < nMasks; mask++) {
+        if ((mask & (mask - 1)) == 0) continue;
+        double* row = &cost[mask * width];
+        for (int j = 0; j < n; j++) {
+            if (!(mask >> j & 1)) continue;
+            const double* prev = &cost[(mask ^ ((size_t)1 << j)) * width];
+            const double* d = &dist[j * width];
+            double best[4] = {inf, inf, inf, inf};
+            for (int k = 0; k < width; k += 4)
+                for (int l = 0; l < 4; l++) {
+                    const double c = prev[k + l] + d[k + l];
+                    best[l] = c < best[l] ? c : best[l];
+                }
+            row[j] = std::min(std::min(best[0], best[1]), std::min(best[2], best[3]));
+        }
+    }
+
+    size_t mask = nMasks - 1;
+    int last = 0;
+    double min_path = inf;
+    for (int j = 0; j < n; j++) {
+        const double length = cost[mask * width + j] + toLast[j];
+        if (length < min_path) {
+            min_path = length;
+            last = j;
+        }
+    }
+
+    // Walk the path back, the previous hit being the one minimizing the cost again
+    for (int i = nHits - 1; i >= nHits - n; i--) {
+        bestPath[i] = last;
+        const size_t prevMask = mask ^ ((size_t)1 << last);
+        if (prevMask == 0) break;
+        const double* prev = &cost[prevMask * width];
+        const double* d = &dist[last * width];
+        int previous = -1;
+        for (int k = 0; k < n; k++)
+            if ((prevMask >> k & 1) && (previous < 0 || prev[k] + d[k] < prev[previous] + d[previous]))
+                previous = k;
+        mask = prevMask;
+        last = previous;
+    }
+    if (fCyclic) bestPath[0] = nHits - 1;
+
     if (this->GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
         cout << "Min path ";
         for (const auto& v : bestPath) cout << v << " ";
@@ -161,8 +804,10 @@ void TRestTrackPathMinimizationProcess::NearestNeighbour(TRestVolumeHits* hits,
 
 ///////////////////////////////////////////////
 /// \brief This function return the index with the shortest path solving
-/// Travelling Salesman Problem (TSP) using brute force,
-/// algorithm complexity is n!, the minimum path is guarantee
+/// Travelling Salesman Problem (TSP) using a depth first branch and bound,
+/// the minimum path is guarantee. Partial paths are pruned against the best
+/// path found, starting from the nearest neighbour paths, using minimum
+/// spanning tree bounds, which keeps tracks of up to about 25 hits practical
 ///
 void TRestTrackPathMinimizationProcess::BruteForce(TRestVolumeHits* hits, std::vector<int>& bestPath) {
     const int nHits = hits->GetNumberOfHits();
@@ -191,44 +836,8 @@ void TRestTrackPathMinimizationProcess::BruteForce(TRestVolumeHits* hits, std::v
         }
     }
 
-    double min_path = 1E9;
-
-    // Find the shortest path starting from all vertex
-    for (int s = 0; s < nHits; s++) {
-        // store all vertex apart from source vertex
-        std::vector<int> vertex(nHits - 1);
-        int index = 0;
-        for (int i = 0; i < nHits; i++) {
-            if (i == s) continue;
-            vertex[index] = i;
-            // debug<<index<<" "<<i<<endl;
-            index++;
-        }
-
-        // store minimum weight Hamiltonian Cycle.
-        do {
-            // store current Path weight(cost)
-            double current_pathweight = 0;
-
-            // compute current path weight
-            int k = s;
-            for (const auto& v : vertex) {
-                current_pathweight += dist[k][v];
-                k = v;
-            }
-            // In case of cyclic
-            if (fCyclic) current_pathweight += dist[k][s];
-
-            // update minimum
-            if (current_pathweight < min_path) {
-                min_path = current_pathweight;
-                bestPath[0] = s;
-                for (size_t i = 0; i < vertex.size(); i++) bestPath[i + 1] = vertex[i];
-            }
-
-            // Could be optimized using the shortest neighbour after computing Floyd Warshall Algorithm
-        } while (std::next_permutation(vertex.begin(), vertex.end()));
-    }
+    PathBranchAndBound search(dist, fCyclic);
+    const double min_path = search.Solve(bestPath);
 
     if (this->GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
         cout << "Min path ";
@@ -239,13 +848,24 @@ void TRestTrackPathMinimizationProcess::BruteForce(TRestVolumeHits* hits, std::v
 
 ///////////////////////////////////////////////
 /// \brief This function eturn the index with the shortest path
-/// Note that this method calls external tsp library and
-/// assumes cyclic data
+/// Note that this method calls external tsp library, which solves the
+/// open path exactly unless fCyclic is set
 ///
-void TRestTrackPathMinimizationProcess::HeldKarp(TRestVolumeHits* hits, std::vector<int>& bestPath) {
+/// The search starts from the LocalSearch path, and it is limited to
+/// fMaxHeldKarpNodes branch and bound nodes and to timeBudget seconds, if not
+/// negative. When a limit is reached the best path found is kept and
+/// HELDKARP_SEARCHLIMITEXCEEDED is returned, these tracks being counted by the
+/// suboptimalTracks observable. It returns HELDKARP_ERROR, keeping the
+/// LocalSearch path, if the tsp library fails, and 0 for the minimum path.
+///
+Int_t TRestTrackPathMinimizationProcess::HeldKarp(TRestVolumeHits* hits, std::vector<int>& bestPath,
+                                                  Double_t timeBudget) {
     const int nHits = hits->GetNumberOfHits();
 
-    if (nHits < 4) return;
+    if (nHits < 4) return 0;
+
+    LocalSearch(hits, bestPath);
+    if (timeBudget == 0) return HELDKARP_SEARCHLIMITEXCEEDED;
 
     Int_t segment_count = nHits * (nHits - 1) / 2;
     int* elen = (int*)malloc(segment_count * sizeof(int));
@@ -263,7 +883,7 @@ void TRestTrackPathMinimizationProcess::HeldKarp(TRestVolumeHits* hits, std::vec
     vector<int> bestP(nHits);
     Int_t rval = 0;
     for (int i = 0; i < nHits; i++) {
-        bestP[i] = i;
+        bestP[i] = bestPath[i];
         for (int j = 0; j < i; j++) {
             TVector3 x0, x1, pos0, pos1;
 
@@ -330,7 +950,10 @@ void TRestTrackPathMinimizationProcess::HeldKarp(TRestVolumeHits* hits, std::vec
         GetChar();
     }
 
-    rval = TrackMinimization_segment(nHits, elen, &bestP[0]);
+    if (fCyclic)
+        rval = TrackMinimization_segment(nHits, elen, &bestP[0], fMaxHeldKarpNodes, timeBudget);
+    else
+        rval = TrackMinimization_path(nHits, elen, &bestP[0], fMaxHeldKarpNodes, timeBudget);
 
     /**** Just Printing
     for( int i = 0; i < hits->GetNumberOfHits()-1; i++ )
@@ -360,15 +983,20 @@ void TRestTrackPathMinimizationProcess::HeldKarp(TRestVolumeHits* hits, std::vec
 
     if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Extreme) GetChar();
 
-    if (rval != 0) {
+    if (rval == HELDKARP_SEARCHLIMITEXCEEDED) {
+        if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Warning) {
+            cout << "REST WARNING. TRestTrackPathMinimizationProcess. HELDKARP BUDGET EXCEEDED." << endl;
+        }
+    } else if (rval != 0) {
         if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Warning) {
             cout << "REST WARNING. TRestTrackPathMinimizationProcess. HELDKARP FAILED." << endl;
         }
-        fOutputTrackEvent->SetOK(false);
-        return;
+        return HELDKARP_ERROR;
     }
 
     for (int i = 0; i < nHits; i++) bestPath[i] = bestP[i];
+
+    return rval;
 }
 
 void TRestTrackPathMinimizationProcess::EndProcess() {}
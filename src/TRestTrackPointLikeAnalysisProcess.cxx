@@ -98,6 +98,8 @@ TRestEvent* TRestTrackPointLikeAnalysisProcess::ProcessEvent(TRestEvent* inputEv
     SetObservableValue("size", totSize);                               // size of the track with more energy
     SetObservableValue("sizeBalance", clusterSizeBalance);             // size balance
 
+    if (fMemoryFootprint) TRestTrackEvent::SetMemoryFootprintObservables(this, fTrackEvent, fTrackEvent);
+
     return fTrackEvent;
 }
 
@@ -110,4 +112,6 @@ void TRestTrackPointLikeAnalysisProcess::EndProcess() {
     // TRestEventProcess::EndProcess();
 }
 
-void TRestTrackPointLikeAnalysisProcess::InitFromConfigFile() {}
+void TRestTrackPointLikeAnalysisProcess::InitFromConfigFile() {
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
+}
@@ -13,6 +13,13 @@
 
 using namespace std;
 
+namespace {
+// Distance between consecutive hits of the track being processed, set by
+// SetDistanceMeanAndSigma. Each thread solving tracks keeps its own.
+thread_local Double_t meanDistance = 0;
+thread_local Double_t sigma = 0;
+}  // namespace
+
 ClassImp(TRestTrackReconnectionProcess);
 
 TRestTrackReconnectionProcess::TRestTrackReconnectionProcess() { Initialize(); }
@@ -55,11 +62,11 @@ TRestEvent* TRestTrackReconnectionProcess::ProcessEvent(TRestEvent* inputEvent)
     fInputTrackEvent = (TRestTrackEvent*)inputEvent;
 
     // Copying the input tracks to the output track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++)
-        fOutputTrackEvent->AddTrack(fInputTrackEvent->GetTrack(tck));
+    fOutputTrackEvent->AddTracks(fInputTrackEvent);
+
+    std::vector<Int_t> branches(fInputTrackEvent->GetNumberOfTracks(), 0);
 
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++) {
-        if (!fInputTrackEvent->isTopLevel(tck)) continue;
+    auto solve = [&](Int_t tck, std::vector<TRestVolumeHits>& tracks) {
         Int_t tckId = fInputTrackEvent->GetTrack(tck)->GetTrackID();
 
         TRestVolumeHits* hits = fInputTrackEvent->GetTrack(tck)->GetVolumeHits();
@@ -75,7 +82,7 @@ TRestEvent* TRestTrackReconnectionProcess::ProcessEvent(TRestEvent* inputEvent)
 
         SetDistanceMeanAndSigma((TRestHits*)hits);
 
-        if (fMeanDistance == 0) continue;  // We have just 1-hit
+        if (meanDistance == 0) return true;  // We have just 1-hit
 
         TRestVolumeHits initialHits = *hits;
         vector<TRestVolumeHits> subHitSets;
@@ -105,7 +112,7 @@ TRestEvent* TRestTrackReconnectionProcess::ProcessEvent(TRestEvent* inputEvent)
 
         // For the observable We just take the value for the track with more number
         // of branches
-        if (tBranches > trackBranches) trackBranches = tBranches;
+        branches[tck] = tBranches;
 
         // A fine tunning applied to consecutive hits
         for (unsigned int n = 0; n < subHitSets[0].GetNumberOfHits(); n++) {
@@ -132,18 +139,17 @@ TRestEvent* TRestTrackReconnectionProcess::ProcessEvent(TRestEvent* inputEvent)
             }
         }
 
-        for (unsigned int n = 0; n < subHitSets.size(); n++) {
-            TRestTrack aTrack;
-            // We create the new track and add it giving its parent ID
-            aTrack.SetTrackID(fOutputTrackEvent->GetNumberOfTracks() + 1);
+        // The new tracks are added giving its parent ID
+        tracks = std::move(subHitSets);
+        return true;
+    };
 
-            aTrack.SetParentID(tckId);
-
-            aTrack.SetVolumeHits(subHitSets[n]);
-
-            fOutputTrackEvent->AddTrack(&aTrack);
-        }
-    }
+    const Int_t nThreads =
+        GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug ? 1 : fTrackThreads;
+    fOutputTrackEvent->EmplaceSolvedTracks(fInputTrackEvent, fInputTrackEvent->GetTopLevelTracks(), solve,
+                                           nThreads);
+    for (const auto& tBranches : branches)
+        if (tBranches > trackBranches) trackBranches = tBranches;
 
     SetObservableValue("branches", trackBranches);
     // cout << "Track branches : " << trackBranches << endl;
@@ -155,6 +161,9 @@ TRestEvent* TRestTrackReconnectionProcess::ProcessEvent(TRestEvent* inputEvent)
         if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Extreme) GetChar();
     }
 
+    if (fMemoryFootprint)
+        TRestTrackEvent::SetMemoryFootprintObservables(this, fInputTrackEvent, fOutputTrackEvent);
+
     return fOutputTrackEvent;
 }
 
@@ -181,11 +190,11 @@ void TRestTrackReconnectionProcess::BreakTracks(TRestVolumeHits* hits, vector<TR
 
         if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug && n > 0) {
             cout << "Distance : " << hits->GetDistance(n - 1, n);
-            if (hits->GetDistance(n - 1, n) > fMeanDistance + nSigma * fSigma) cout << " BREAKKKK";
+            if (hits->GetDistance(n - 1, n) > meanDistance + nSigma * sigma) cout << " BREAKKKK";
             cout << endl;
         }
 
-        if (n > 0 && hits->GetDistance(n - 1, n) > fMeanDistance + nSigma * fSigma) {
+        if (n > 0 && hits->GetDistance(n - 1, n) > meanDistance + nSigma * sigma) {
             hitSets.emplace_back(subHits);
             subHits.RemoveHits();
         }
@@ -365,7 +374,7 @@ Int_t TRestTrackReconnectionProcess::GetTrackBranches(TRestHits& h, Double_t nSi
     Int_t nHits = h.GetNumberOfHits();
 
     for (int n = 1; n < nHits; n++)
-        if (h.GetDistance(n - 1, n) > fMeanDistance + nSigma * fSigma) breaks++;
+        if (h.GetDistance(n - 1, n) > meanDistance + nSigma * sigma) breaks++;
     return breaks;
 }
 
@@ -378,20 +387,24 @@ void TRestTrackReconnectionProcess::InitFromConfigFile() {
         fSplitTrack = false;
 
     fNSigmas = StringToDouble(GetParameter("nSigmas", "5"));
+
+    fTrackThreads = StringToInteger(GetParameter("trackThreads", "1"));
+
+    if (GetParameter("memoryFootprint", "false") == "true") fMemoryFootprint = true;
 }
 
 void TRestTrackReconnectionProcess::SetDistanceMeanAndSigma(TRestHits* h) {
     Int_t nHits = h->GetNumberOfHits();
 
-    fMeanDistance = 0;
-    for (int n = 1; n < nHits; n++) fMeanDistance += h->GetDistance(n - 1, n);
-    fMeanDistance /= nHits;
+    meanDistance = 0;
+    for (int n = 1; n < nHits; n++) meanDistance += h->GetDistance(n - 1, n);
+    meanDistance /= nHits;
 
-    fSigma = TMath::Sqrt(fMeanDistance);
+    sigma = TMath::Sqrt(meanDistance);
 
     if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
-        cout << "-----> Node distance average ; " << fMeanDistance << endl;
-        cout << "-----> Node distance sigma : " << fSigma << endl;
+        cout << "-----> Node distance average ; " << meanDistance << endl;
+        cout << "-----> Node distance sigma : " << sigma << endl;
         cout << endl;
     }
 }
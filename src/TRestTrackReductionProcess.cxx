@@ -33,16 +33,13 @@ TRestEvent* TRestTrackReductionProcess::ProcessEvent(TRestEvent* inputEvent) {
     fOutputTrackEvent->SetEventInfo(fInputTrackEvent);
 
     // Copying the input tracks to the output track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++)
-        fOutputTrackEvent->AddTrack(fInputTrackEvent->GetTrack(tck));
+    fOutputTrackEvent->AddTracks(fInputTrackEvent);
 
     if (this->GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug)
         fInputTrackEvent->PrintOnlyTracks();
 
     // Reducing the hits inside each track
-    for (int tck = 0; tck < fInputTrackEvent->GetNumberOfTracks(); tck++) {
-        if (!fInputTrackEvent->isTopLevel(tck)) continue;
-
+    auto solve = [&](Int_t tck, std::vector<TRestVolumeHits>& tracks) {
         TRestTrack* track = fInputTrackEvent->GetTrack(tck);
         TRestVolumeHits* hits = track->GetVolumeHits();
 
@@ -62,14 +59,20 @@ TRestEvent* TRestTrackReductionProcess::ProcessEvent(TRestEvent* inputEvent) {
                 nHitsAfter = vHits.GetNumberOfHits();
             } while (nHitsBefore != nHitsAfter);
         }
-        TRestTrack newTrack;
-        newTrack.SetVolumeHits(vHits);
-        newTrack.SetParentID(track->GetTrackID());
-        newTrack.SetTrackID(fOutputTrackEvent->GetNumberOfTracks() + 1);
-        fOutputTrackEvent->AddTrack(&newTrack);
-    }
+        tracks.emplace_back(std::move(vHits));
+        return true;
+    };
+
+    const Int_t nThreads =
+        GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug ? 1 : fTrackThreads;
+    fOutputTrackEvent->EmplaceSolvedTracks(fInputTrackEvent, fInputTrackEvent->GetTopLevelTracks(), solve,
+                                           nThreads);
 
     fOutputTrackEvent->SetLevels();
+
+    if (fMemoryFootprint)
+        TRestTrackEvent::SetMemoryFootprintObservables(this, fInputTrackEvent, fOutputTrackEvent);
+
     return fOutputTrackEvent;
 }
 
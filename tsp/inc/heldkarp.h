@@ -22,12 +22,13 @@
 #include "util.h"
 
 int CCheldkarp_small(int ncount, CCdatagroup* dat, double* upbound, double* optval, int* foundtour,
-                     int anytour, int* tour_elist, int nodelimit, int silent),
+                     int anytour, int* tour_elist, int nodelimit, double timelimit, int silent),
     CCheldkarp_small_elist(int ncount, int ecount, int* elist, int* elen, double* upbound, double* optval,
-                           int* foundtour, int anytour, int* tour_elist, int nodelimit, int silent);
+                           int* foundtour, int anytour, int* tour_elist, int nodelimit, double timelimit,
+                           int silent);
 
 // Added to introduce user-defined distance matrix (through *elen)
 int CCheldkarp_small_segment(int ncount, int* elen, double* upbound, double* optval, int* foundtour,
-                             int anytour, int* tour_elist, int nodelimit, int silent);
+                             int anytour, int* tour_elist, int nodelimit, double timelimit, int silent);
 
 #endif /* __HELDKARP_H */
@@ -17,7 +17,13 @@ extern "C"
 extern "C"
 #endif
     int
-    TrackMinimization_segment(int ncount, int* elen, int* mytour);
+    TrackMinimization_segment(int ncount, int* elen, int* mytour, int nodelimit, double timelimit);
+
+#ifdef __cplusplus
+extern "C"
+#endif
+    int
+    TrackMinimization_path(int ncount, int* elen, int* mytour, int nodelimit, double timelimit);
 
 #ifdef __cplusplus
 extern "C"
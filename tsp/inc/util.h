@@ -404,14 +404,11 @@ int CCelist_alloc(CCelist* elist, int ecount), CCelistl_alloc(CCelistl* elist, i
 
 /****************************************************************************/
 /*                                                                          */
-/*  Before defining CCUTIL_EDGELEN_FUNCTIONPTR, read the notes at the top   */
-/*  of edgelen.c, and carefully consider the consequences.  You probably    */
-/*  do not want CCUTIL_EDGELEN_FUNCTIONPTR defined.                         */
+/*  The norm lives in each CCdatagroup, see the notes at the top of         */
+/*  edgelen.c. There is no global edgelen function pointer.                 */
 /*                                                                          */
 /****************************************************************************/
 
-#undef CCUTIL_EDGELEN_FUNCTIONPTR
-
 typedef struct CCdata_user {
     double* x;
     double* y;
@@ -453,11 +450,7 @@ typedef struct CCdatagroup {
     int* orig_names; /* the nodes names from full problem */
 } CCdatagroup;
 
-#ifdef CCUTIL_EDGELEN_FUNCTIONPTR
-extern int (*CCutil_dat_edgelen)(int i, int j, CCdatagroup* dat);
-#else  /* CCUTIL_EDGELEN_FUNCTIONPTR */
 int CCutil_dat_edgelen(int i, int j, CCdatagroup* dat);
-#endif /* CCUTIL_EDGELEN_FUNCTIONPTR */
 
 int CCutil_dat_setnorm(CCdatagroup* dat, int norm);
 
@@ -57,23 +57,12 @@
 /*             CC_RHMAPx - where x = 1, 2, 3, 4, 5 one of 5 RH mapping      */
 /*                norms.                                                    */
 /*                                                                          */
-/*         If CCUTIL_EDGELEN_FUNCTIONPTR has been defined in util.h,        */
-/*         then CCutil_dat_edgelen is a pointer to a function instead of    */
-/*         a function.  This saves a function call and results in           */
-/*         improved performance on some machines for edgelen-intensive      */
-/*         routines like linkern.  The function pointer is set by           */
-/*         CCutil_dat_setnorm.                                              */
-/*                                                                          */
-/*         IMPORTANT: This means that if CCUTIL_EDGELEN_FUNCTIONPTR is set  */
-/*         and you have more than one CCdatagroup, you must call            */
-/*         CCutil_dat_setnorm whenever you switch from using one            */
-/*         CCdatagroup to the other.  IF YOU DON'T DO THIS, EDGELEN WILL    */
-/*         RETURN INCORRECT RESULTS.  For this reason,                      */
-/*         CCUTIL_EDGELEN_FUNCTIONPTR should only be set with extreme       */
-/*         caution.                                                         */
-/*                                                                          */
-/*         NOTE: CCUTIL_EDGELEN_FUNCTIONPTR does not work with the          */
-/*         subdivision code for parallel TSP.                               */
+/*         The norm is stored in the CCdatagroup only (dat->edgelen),       */
+/*         and CCutil_dat_edgelen dispatches through it. The original       */
+/*         CCUTIL_EDGELEN_FUNCTIONPTR option, where CCutil_dat_setnorm      */
+/*         also set a global function pointer shared by all datagroups,     */
+/*         has been removed so that several datagroups, with different      */
+/*         norms, can be used at the same time from different threads.      */
 /*                                                                          */
 /*    To define a user norm, you must perform the following steps:          */
 /*    1.  In util.h, define the struct CCdata_user to contain the data      */
@@ -138,12 +127,6 @@ static void init_userdat(CCdata_user* userdat), free_userdat(CCdata_user* userda
 #define M_PI 3.14159265358979323846264
 #endif
 
-#ifdef CCUTIL_EDGELEN_FUNCTIONPTR
-
-int (*CCutil_dat_edgelen)(int i, int j, CCdatagroup* dat) = edgelen_nonorm;
-
-#else /* CCUTIL_EDGELEN_FUNCTIONPTR */
-
 int CCutil_dat_edgelen(int i, int j, CCdatagroup* dat) {
     if (dat->ndepot) {
         if (i >= dat->orig_ncount) {
@@ -155,8 +138,6 @@ int CCutil_dat_edgelen(int i, int j, CCdatagroup* dat) {
     return (dat->edgelen)(i, j, dat);
 }
 
-#endif /* CCUTIL_EDGELEN_FUNCTIONPTR */
-
 int CCutil_dat_setnorm(CCdatagroup* dat, int norm) {
     switch (norm) {
         case CC_EUCLIDEAN_CEIL:
@@ -222,10 +203,6 @@ int CCutil_dat_setnorm(CCdatagroup* dat, int norm) {
     }
     dat->norm = norm;
 
-#ifdef CCUTIL_EDGELEN_FUNCTIONPTR
-    CCutil_dat_edgelen = dat->edgelen;
-#endif /* CCUTIL_EDGELEN_FUNCTIONPTR */
-
     return 0;
 }
 
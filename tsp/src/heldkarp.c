@@ -29,7 +29,7 @@
 /*                                                                          */
 /*  int CCheldkarp_small (int ncount, CCdatagroup *dat, double *upbound,    */
 /*      double *optval, int *foundtour, int anytour, int *tour_elist,       */
-/*      int nodelimit, int silent)                                          */
+/*      int nodelimit, double timelimit, int silent)                        */
 /*    -ncount is the number of nodes in the graph.                          */
 /*    -dat specifies the information needed to compute the edge lengths.    */
 /*    -upbound is an upperbound on the optimal tour length (it can be       */
@@ -45,12 +45,17 @@
 /*     at least 2*ncount.  Can be NULL.                                     */
 /*    -nodelimit specifies a limit on the number of search nodes (use -1    */
 /*     to impose no limit)                                                  */
+/*    -timelimit specifies a limit in seconds on the wall-clock time of     */
+/*     the search (use -1 to impose no limit). When a limit is reached      */
+/*     HELDKARP_SEARCHLIMITEXCEEDED is returned, and tour_elist holds the   */
+/*     best tour found if foundtour is 1.                                   */
 /*    -silent should be set to 1 to restrict the output and 2 to            */
 /*     disable all normal output                                            */
 /*                                                                          */
 /*  int CCheldkarp_small_elist (int ncount, int ecount, int *elist,         */
 /*      int *elen, int *upbound, int *optval, int *foundtour,               */
-/*      int anytour, int *tour_elist, int nodelimit, int silent)            */
+/*      int anytour, int *tour_elist, int nodelimit, double timelimit,      */
+/*      int silent)                                                         */
 /*     USES edgelist rather than datagroup.                                 */
 /*      -ecount is the number of edges in the graph.                        */
 /*      -elist is the list of edges in end0 end1 format.                    */
@@ -72,7 +77,9 @@
 
 #define LINE_LEN (75)
 
-#define MAX_NODES (100)
+/* One more than the 100 hits of the largest track, for the dummy node that */
+/* TrackMinimization_path adds to solve open paths                          */
+#define MAX_NODES (101)
 #define WEIGHT_ADJUST (5)
 #define WEIGHT_MULT (1 << WEIGHT_ADJUST)
 #define WEIGHT_MAX_EDGE (1 << (20 - WEIGHT_ADJUST)) /* no overflow */
@@ -91,17 +98,19 @@ typedef struct treenode {
 static void initial_y(int ncount, int ecount, int* elist, int* len, int* y),
     hk_work(int ncount, int* elist, int* elen, int* len, int** adjlist, int* zadjlist, int* y, int* deg,
             int* upperbound, int* tree, int* foundtour, int* besttour, int* efix, int* degfix, int depth,
-            int* bbcount, int just_verify, int silent, int nodelimit),
+            int* bbcount, int just_verify, int silent, int nodelimit, double deadline, int* timedout),
     held_karp_bound(int ncount, int* elist, int* elen, int* len, int** adjlist, int* zadjlist, int* y,
                     int* deg, int upperbound, int* tree, int* val, int* newtour, int* besttour, int maxiter,
-                    double beta, int silent),
+                    double beta, double deadline, int silent),
     one_tree(int ncount, int* elist, int* len, int** adjlist, int* zadjlist, int* y, int* tree, int* notree),
     span_tree(int nnodes, int** adjlist, int elen[], int y[], int sptree[], int* notree),
     edge_select(int ncount, int* elist, int* len, int* y, int* tree, int* efix, int* ebranch),
     set_adjlist(int n0, int n1, int** adjlist, int* zadjlist, int val);
 
+static double hk_real_zeit(void);
+
 int CCheldkarp_small(int ncount, CCdatagroup* dat, double* upbound, double* optval, int* foundtour,
-                     int anytour, int* tour_elist, int nodelimit, int silent) {
+                     int anytour, int* tour_elist, int nodelimit, double timelimit, int silent) {
     int rval = 0;
     int i, j, k, ecount;
     int* elist = (int*)NULL;
@@ -126,7 +135,7 @@ int CCheldkarp_small(int ncount, CCdatagroup* dat, double* upbound, double* optv
     }
 
     rval = CCheldkarp_small_elist(ncount, ecount, elist, elen, upbound, optval, foundtour, anytour,
-                                  tour_elist, nodelimit, silent);
+                                  tour_elist, nodelimit, timelimit, silent);
 
 CLEANUP:
 
@@ -139,7 +148,7 @@ CLEANUP:
 /// This version takes the segment distance matrix directly as elen
 /// The elen distances should be given in the same elist order
 int CCheldkarp_small_segment(int ncount, int* elen, double* upbound, double* optval, int* foundtour,
-                             int anytour, int* tour_elist, int nodelimit, int silent) {
+                             int anytour, int* tour_elist, int nodelimit, double timelimit, int silent) {
     int rval = 0;
     int i, j, k, ecount;
     int* elist = (int*)NULL;
@@ -164,7 +173,7 @@ int CCheldkarp_small_segment(int ncount, int* elen, double* upbound, double* opt
     }
 
     rval = CCheldkarp_small_elist(ncount, ecount, elist, elen, upbound, optval, foundtour, anytour,
-                                  tour_elist, nodelimit, silent);
+                                  tour_elist, nodelimit, timelimit, silent);
 
 CLEANUP:
 
@@ -180,9 +189,12 @@ CLEANUP:
  */
 
 int CCheldkarp_small_elist(int ncount, int ecount, int* elist, int* elen, double* upbound, double* optval,
-                           int* foundtour, int anytour, int* tour_elist, int nodelimit, int silent) {
+                           int* foundtour, int anytour, int* tour_elist, int nodelimit, double timelimit,
+                           int silent) {
     int rval = 0;
     int bbcount = 0;
+    int timedout = 0;
+    double deadline = (timelimit < 0 ? -1.0 : hk_real_zeit() + timelimit);
     int init_ub = ncount * WEIGHT_MAX_EDGE + 1;
     int n1, n2, i, upperbound, val;
     int* p;
@@ -273,14 +285,14 @@ int CCheldkarp_small_elist(int ncount, int ecount, int* elist, int* elen, double
     for (i = 0; i < ncount; i++) degfix[i] = 0;
 
     hk_work(ncount, elist, elen, len, adjlist, zadjlist, y, deg, &val, tree, foundtour, besttour, efix,
-            degfix, 0, &bbcount, anytour, silent, nodelimit);
+            degfix, 0, &bbcount, anytour, silent, nodelimit, deadline, &timedout);
 
     if (silent < 2) {
         printf("BBnodes: %d\n", bbcount);
         fflush(stdout);
     }
 
-    if (nodelimit != -1 && bbcount > nodelimit) {
+    if ((nodelimit != -1 && bbcount > nodelimit) || timedout) {
         rval = HELDKARP_SEARCHLIMITEXCEEDED;
     } else {
         *optval = (double)val;
@@ -323,17 +335,22 @@ static void initial_y(int ncount, int ecount, int* elist, int* len, int* y) {
 
 static void hk_work(int ncount, int* elist, int* elen, int* len, int** adjlist, int* zadjlist, int* y,
                     int* deg, int* upperbound, int* tree, int* foundtour, int* besttour, int* efix,
-                    int* degfix, int depth, int* bbcount, int just_verify, int silent, int nodelimit) {
+                    int* degfix, int depth, int* bbcount, int just_verify, int silent, int nodelimit,
+                    double deadline, int* timedout) {
     int ebranch, n0, n1, maxiter, val, newtour;
     double beta;
     int i;
 
     (*bbcount)++;
     if (nodelimit != -1 && *bbcount > nodelimit) return;
+    if (*timedout || (deadline >= 0 && hk_real_zeit() > deadline)) {
+        *timedout = 1;
+        return;
+    }
     maxiter = (depth > 0 ? 10 : 1000);
     beta = (depth > 0 ? 0.9 : 0.99);
     held_karp_bound(ncount, elist, elen, len, adjlist, zadjlist, y, deg, *upperbound, tree, &val, &newtour,
-                    besttour, maxiter, beta, silent);
+                    besttour, maxiter, beta, deadline, silent);
     if (newtour == 1) {
         *foundtour = 1;
         *upperbound = val;
@@ -353,7 +370,7 @@ static void hk_work(int ncount, int* elist, int* elen, int* len, int** adjlist,
         fflush(stdout);
     }
     hk_work(ncount, elist, elen, len, adjlist, zadjlist, y, deg, upperbound, tree, foundtour, besttour, efix,
-            degfix, depth + 1, bbcount, just_verify, silent, nodelimit);
+            degfix, depth + 1, bbcount, just_verify, silent, nodelimit, deadline, timedout);
     if (!silent && depth < LINE_LEN) {
         printf("\b \b");
         fflush(stdout);
@@ -374,7 +391,7 @@ static void hk_work(int ncount, int* elist, int* elen, int* len, int** adjlist,
             fflush(stdout);
         }
         hk_work(ncount, elist, elen, len, adjlist, zadjlist, y, deg, upperbound, tree, foundtour, besttour,
-                efix, degfix, depth + 1, bbcount, just_verify, silent, nodelimit);
+                efix, degfix, depth + 1, bbcount, just_verify, silent, nodelimit, deadline, timedout);
         if (!silent && depth < LINE_LEN) {
             printf("\b \b");
             fflush(stdout);
@@ -389,7 +406,7 @@ static void hk_work(int ncount, int* elist, int* elen, int* len, int** adjlist,
 
 static void held_karp_bound(int ncount, int* elist, int* elen, int* len, int** adjlist, int* zadjlist, int* y,
                             int* deg, int upperbound, int* tree, int* val, int* newtour, int* besttour,
-                            int maxiter, double beta, int silent) {
+                            int maxiter, double beta, double deadline, int silent) {
     int i, k, t, tlen, ysum, square, notree, newsum;
     int abound = (upperbound << WEIGHT_ADJUST);
     int goal = ((upperbound - 1) << WEIGHT_ADJUST);
@@ -436,6 +453,8 @@ static void held_karp_bound(int ncount, int* elist, int* elen, int* len, int** a
             return;
         }
         if (++iter >= maxiter) break;
+        /* Any of the 1-trees so far gives a bound, so it is safe to stop here */
+        if (deadline >= 0 && hk_real_zeit() > deadline) break;
 
         t = (int)(alpha * (double)((abound - tlen)) / (double)square);
         if (t < 2) break;
@@ -592,3 +611,15 @@ static void set_adjlist(int n0, int n1, int** adjlist, int* zadjlist, int val) {
     else
         adjlist[n0 - 1][n1 - 1] = adjlist[n1 - 1][n0 - 1] = val;
 }
+
+/* Wall-clock time in seconds, for the timelimit of the search */
+static double hk_real_zeit(void) {
+#ifdef HAVE_SYS_TIME_H
+    struct timeval tv;
+
+    gettimeofday(&tv, (struct timezone*)NULL);
+    return (double)tv.tv_sec + 1e-6 * (double)tv.tv_usec;
+#else
+    return (double)time(0);
+#endif
+}
@@ -34,7 +34,14 @@
 #include "trackMinimization.h"
 
 static int runHeldKarp(int ncount, CCdatagroup* dat, int* hk_tour);
-static int runHeldKarp_segment(int ncount, int* elen, int* hk_tour);
+static int runHeldKarp_segment(int ncount, int* elen, int* hk_tour, int nodelimit, double timelimit);
+static int runHeldKarp_path(int ncount, int* elen, int* hk_path, int nodelimit, double timelimit);
+static int solveHeldKarp(int ncount, int* elen, int* hk_tour, int nodelimit, double timelimit);
+
+/* The TrackMinimization functions are reentrant: all their state lives in the    */
+/* arguments, on the stack or in memory allocated for the call, and the norm of   */
+/* a datagroup is only stored in the datagroup itself. They can be called at the  */
+/* same time from different threads on different data.                            */
 
 int TrackMinimization_3D(int* xIn, int* yIn, int* zIn, int ncount, int* mytour) {
     int rval = 0;
@@ -47,11 +54,17 @@ int TrackMinimization_3D(int* xIn, int* yIn, int* zIn, int ncount, int* mytour)
     /////////////////////////////////////////////
     // Initializing dat structure
     CCutil_init_datagroup(&dat);
-    CCutil_dat_setnorm(&dat, CC_EUCLIDEAN_3D);
+    rval = CCutil_dat_setnorm(&dat, CC_EUCLIDEAN_3D);
+    CCcheck_rval(rval, "CCutil_dat_setnorm failed");
 
     dat.x = CC_SAFE_MALLOC(ncount, double);
     dat.y = CC_SAFE_MALLOC(ncount, double);
     dat.z = CC_SAFE_MALLOC(ncount, double);
+    if (!dat.x || !dat.y || !dat.z) {
+        fprintf(stderr, "out of memory for dat\n");
+        rval = 1;
+        goto CLEANUP;
+    }
     for (i = 0; i < ncount; i++) {
         dat.x[i] = (double)xIn[i];
         dat.y[i] = (double)yIn[i];
@@ -85,30 +98,21 @@ CLEANUP:
     return rval;
 }
 
-int TrackMinimization_segment(int ncount, int* elen, int* mytour) {
-    int rval = 0;
-    int i;
-    int* besttour = (int*)NULL;
-
-    if (ncount <= 3) return rval;
-
-    /////////////////////////////////////////////
-    // Solving using Held-Karp
-    besttour = CC_SAFE_MALLOC(ncount, int);
-    CCcheck_NULL(besttour, "out of memory for besttour");
-    rval = runHeldKarp_segment(ncount, elen, besttour);
-    CCcheck_rval(rval, "runHeldKarp failed");
-    /////////////////////////////////////////////
-
-    for (i = 0; i < ncount; i++) mytour[i] = besttour[i];
+/* mytour holds a starting tour on input, whose length bounds the search, and the */
+/* best tour found on output. HELDKARP_SEARCHLIMITEXCEEDED is returned when the   */
+/* nodelimit or timelimit (-1 for none) is reached before the tour is proven      */
+/* optimal, mytour still holding the best tour found.                             */
+int TrackMinimization_segment(int ncount, int* elen, int* mytour, int nodelimit, double timelimit) {
+    if (ncount <= 3) return 0;
 
-    goto CLEANUP;
-
-CLEANUP:
+    return runHeldKarp_segment(ncount, elen, mytour, nodelimit, timelimit);
+}
 
-    CC_IFFREE(besttour, int);
+/* Same as TrackMinimization_segment, for the open path through the nodes */
+int TrackMinimization_path(int ncount, int* elen, int* mytour, int nodelimit, double timelimit) {
+    if (ncount <= 3) return 0;
 
-    return rval;
+    return runHeldKarp_path(ncount, elen, mytour, nodelimit, timelimit);
 }
 
 int TrackMinimization_2D(int* xIn, int* yIn, int ncount, int* mytour) {
@@ -120,10 +124,16 @@ int TrackMinimization_2D(int* xIn, int* yIn, int ncount, int* mytour) {
     /////////////////////////////////////////////
     // Initializing dat structure
     CCutil_init_datagroup(&dat);
-    CCutil_dat_setnorm(&dat, CC_EUCLIDEAN);
+    rval = CCutil_dat_setnorm(&dat, CC_EUCLIDEAN);
+    CCcheck_rval(rval, "CCutil_dat_setnorm failed");
 
     dat.x = CC_SAFE_MALLOC(ncount, double);
     dat.y = CC_SAFE_MALLOC(ncount, double);
+    if (!dat.x || !dat.y) {
+        fprintf(stderr, "out of memory for dat\n");
+        rval = 1;
+        goto CLEANUP;
+    }
     for (i = 0; i < ncount; i++) {
         dat.x[i] = (double)xIn[i];
         dat.y[i] = (double)yIn[i];
@@ -134,6 +144,7 @@ int TrackMinimization_2D(int* xIn, int* yIn, int ncount, int* mytour) {
     // Solving using Held-Karp
     besttour = CC_SAFE_MALLOC(ncount, int);
     CCcheck_NULL(besttour, "out of memory for besttour");
+    for (i = 0; i < ncount; i++) besttour[i] = i;
     if (ncount > 3) {
         rval = runHeldKarp(ncount, &dat, besttour);
         CCcheck_rval(rval, "runHeldKarp failed");
@@ -157,77 +168,114 @@ CLEANUP:
     return rval;
 }
 
+/* Open path over the nodes of dat, i.e. the track order of the hits */
 static int runHeldKarp(int ncount, CCdatagroup* dat, int* hk_tour) {
-    double hk_val;
-    int hk_found, hk_yesno;
-    int* hk_tlist = (int*)NULL;
+    int* elen = (int*)NULL;
     int rval = 0;
-    int m = 0;
-    int i = 0;
-    int silent = 2;
+    int i, j, k;
 
-    hk_tlist = CC_SAFE_MALLOC(2 * ncount, int);
-    CCcheck_NULL(hk_tlist, "out of memory for hk_tlist");
+    elen = CC_SAFE_MALLOC(ncount * (ncount - 1) / 2, int);
+    CCcheck_NULL(elen, "out of memory for elen");
 
-    rval = CCheldkarp_small(ncount, dat, (double*)NULL, &hk_val, &hk_found, 0, hk_tlist, 1000000, silent);
-    CCcheck_rval(rval, "CCheldkarp_small failed");
-    // printf ("Optimal Solution: %.2f\n", hk_val); fflush (stdout);
+    for (i = 0, k = 0; i < ncount; i++) {
+        hk_tour[i] = i;
+        for (j = 0; j < i; j++) elen[k++] = CCutil_dat_edgelen(i, j, dat);
+    }
+
+    rval = runHeldKarp_path(ncount, elen, hk_tour, 1000000, -1.0);
+    CCcheck_rval(rval, "runHeldKarp_path failed");
+
+CLEANUP:
+
+    CC_IFFREE(elen, int);
+    return rval;
+}
+
+/* Closed tour over the ncount nodes, elen given in lower triangular order */
+static int runHeldKarp_segment(int ncount, int* elen, int* hk_tour, int nodelimit, double timelimit) {
+    return solveHeldKarp(ncount, elen, hk_tour, nodelimit, timelimit);
+}
 
-    rval = CCutil_edge_to_cycle(ncount, hk_tlist, &hk_yesno, hk_tour);
-
-    int contiguos = 1;
-    while (contiguos) {
-        contiguos = 0;
-        for (i = 1; i < ncount; i++) {
-            if (hk_tour[i] - hk_tour[i - 1] == ncount - 1) contiguos = 1;
-            if (hk_tour[i] - hk_tour[i - 1] == 1 - ncount) contiguos = 1;
-        }
-
-        if (contiguos) {
-            int tmp = hk_tour[0];
-            for (i = 1; i < ncount; i++) hk_tour[i - 1] = hk_tour[i];
-            hk_tour[ncount - 1] = tmp;
-        }
+/* Open path over the ncount nodes, elen given in lower triangular order.   */
+/* A dummy node at zero distance from all the others is added as node 0, so */
+/* the optimal tour over ncount + 1 nodes is the optimal path closed        */
+/* through it, and the path is obtained cutting the tour at the dummy node. */
+/* Being node 0, the dummy node is the one left out of the 1-trees, which  */
+/* makes their bound the minimum spanning tree of the real nodes.           */
+static int runHeldKarp_path(int ncount, int* elen, int* hk_path, int nodelimit, double timelimit) {
+    int* hk_elen = (int*)NULL;
+    int* hk_tour = (int*)NULL;
+    int rval = 0;
+    int i, j, k, m, start;
+    int dcount = ncount + 1;
+
+    /* Failures are reported as HELDKARP_ERROR, CCcheck_NULL would give the */
+    /* value of HELDKARP_SEARCHLIMITEXCEEDED                                */
+    hk_elen = CC_SAFE_MALLOC(dcount * (dcount - 1) / 2, int);
+    hk_tour = CC_SAFE_MALLOC(dcount, int);
+    if (!hk_elen || !hk_tour) {
+        fprintf(stderr, "out of memory in runHeldKarp_path\n");
+        rval = HELDKARP_ERROR;
+        goto CLEANUP;
+    }
+
+    /* Row i of the extended matrix is the dummy edge followed by row i - 1 of elen */
+    for (i = 1, k = 0, m = 0; i < dcount; i++) {
+        hk_elen[k++] = 0;
+        for (j = 1; j < i; j++) hk_elen[k++] = elen[m++];
     }
 
+    hk_tour[0] = 0;
+    for (i = 0; i < ncount; i++) hk_tour[i + 1] = hk_path[i] + 1;
+
+    rval = solveHeldKarp(dcount, hk_elen, hk_tour, nodelimit, timelimit);
+    if (rval != 0 && rval != HELDKARP_SEARCHLIMITEXCEEDED) goto CLEANUP;
+
+    for (start = 0; hk_tour[start] != 0; start++)
+        ;
+    for (i = 0; i < ncount; i++) hk_path[i] = hk_tour[(start + 1 + i) % dcount] - 1;
+
 CLEANUP:
 
-    CC_IFFREE(hk_tlist, int);
+    CC_IFFREE(hk_elen, int);
+    CC_IFFREE(hk_tour, int);
     return rval;
 }
 
-static int runHeldKarp_segment(int ncount, int* elen, int* hk_tour) {
-    double hk_val;
+/* Tour over the ncount nodes, starting from the tour in hk_tour, which is */
+/* replaced only if a shorter one is found                                 */
+static int solveHeldKarp(int ncount, int* elen, int* hk_tour, int nodelimit, double timelimit) {
+    double hk_val, upbound = 0.0;
     int hk_found, hk_yesno;
     int* hk_tlist = (int*)NULL;
     int rval = 0;
-    int m = 0;
-    int i = 0;
+    int i, a, b;
     int silent = 2;
 
     hk_tlist = CC_SAFE_MALLOC(2 * ncount, int);
-    CCcheck_NULL(hk_tlist, "out of memory for hk_tlist");
+    if (!hk_tlist) {
+        fprintf(stderr, "out of memory in solveHeldKarp\n");
+        rval = HELDKARP_ERROR;
+        goto CLEANUP;
+    }
+
+    for (i = 0; i < ncount; i++) {
+        a = hk_tour[i];
+        b = hk_tour[(i + 1) % ncount];
+        upbound += (a > b ? elen[a * (a - 1) / 2 + b] : elen[b * (b - 1) / 2 + a]);
+    }
 
-    rval = CCheldkarp_small_segment(ncount, elen, (double*)NULL, &hk_val, &hk_found, 0, hk_tlist, 1000000,
-                                    silent);
-    CCcheck_rval(rval, "CCheldkarp_small failed");
+    rval = CCheldkarp_small_segment(ncount, elen, &upbound, &hk_val, &hk_found, 0, hk_tlist, nodelimit,
+                                    timelimit, silent);
+    if (rval != 0 && rval != HELDKARP_SEARCHLIMITEXCEEDED) {
+        fprintf(stderr, "CCheldkarp_small failed\n");
+        goto CLEANUP;
+    }
     // printf ("Optimal Solution: %.2f\n", hk_val); fflush (stdout);
 
-    rval = CCutil_edge_to_cycle(ncount, hk_tlist, &hk_yesno, hk_tour);
-
-    int contiguos = 1;
-    while (contiguos) {
-        contiguos = 0;
-        for (i = 1; i < ncount; i++) {
-            if (hk_tour[i] - hk_tour[i - 1] == ncount - 1) contiguos = 1;
-            if (hk_tour[i] - hk_tour[i - 1] == 1 - ncount) contiguos = 1;
-        }
-
-        if (contiguos) {
-            int tmp = hk_tour[0];
-            for (i = 1; i < ncount; i++) hk_tour[i - 1] = hk_tour[i];
-            hk_tour[ncount - 1] = tmp;
-        }
+    if (hk_found) {
+        i = CCutil_edge_to_cycle(ncount, hk_tlist, &hk_yesno, hk_tour);
+        if (i) rval = HELDKARP_ERROR;
     }
 
 CLEANUP:
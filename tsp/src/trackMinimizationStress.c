@@ -0,0 +1,164 @@
+/****************************************************************************/
+/*                                                                          */
+/*              STRESS TEST OF THE TRACK MINIMIZATION ENTRY POINTS          */
+/*                                                                          */
+/*  It solves a fixed set of random tracks with TrackMinimization_2D,       */
+/*  TrackMinimization_3D and TrackMinimization_path, first serially and     */
+/*  then several times on nthreads threads at once, and checks that every   */
+/*  tour found by the threads is the one of the serial run.                 */
+/*                                                                          */
+/*  Usage: trackMinimizationStress [nthreads] [njobs] [repeats]             */
+/*                                                                          */
+/*  It returns 0 when all the tours match, 1 otherwise.                     */
+/*                                                                          */
+/****************************************************************************/
+
+#include <math.h>
+#include <pthread.h>
+
+#include "trackMinimization.h"
+
+#define MAX_JOB_NODES (14)
+
+typedef struct stress_job {
+    int kind; /* 0 for TrackMinimization_2D, 1 for _3D and 2 for _path */
+    int ncount;
+    int x[MAX_JOB_NODES];
+    int y[MAX_JOB_NODES];
+    int z[MAX_JOB_NODES];
+    int serialtour[MAX_JOB_NODES];
+    int tour[MAX_JOB_NODES];
+    int rval;
+} stress_job;
+
+typedef struct stress_worker {
+    stress_job* jobs;
+    int njobs;
+    int first;
+    int step;
+} stress_worker;
+
+static int solve_job(stress_job* job, int* tour);
+static void* run_worker(void* arg);
+static unsigned int next_random(unsigned int* seed);
+
+int main(int ac, char** av) {
+    int nthreads = ac > 1 ? atoi(av[1]) : 8;
+    int njobs = ac > 2 ? atoi(av[2]) : 96;
+    int repeats = ac > 3 ? atoi(av[3]) : 5;
+    stress_job* jobs = (stress_job*)NULL;
+    stress_worker* workers = (stress_worker*)NULL;
+    pthread_t* threads = (pthread_t*)NULL;
+    unsigned int seed = 12345;
+    int mismatches = 0;
+    int rval = 0;
+    int i, k, r;
+
+    if (nthreads < 1 || njobs < 1 || repeats < 1) {
+        fprintf(stderr, "Usage: %s [nthreads] [njobs] [repeats]\n", av[0]);
+        return 1;
+    }
+
+    jobs = CC_SAFE_MALLOC(njobs, stress_job);
+    workers = CC_SAFE_MALLOC(nthreads, stress_worker);
+    threads = CC_SAFE_MALLOC(nthreads, pthread_t);
+    if (!jobs || !workers || !threads) {
+        fprintf(stderr, "out of memory in trackMinimizationStress\n");
+        rval = 1;
+        goto CLEANUP;
+    }
+
+    for (i = 0; i < njobs; i++) {
+        jobs[i].kind = i % 3;
+        jobs[i].ncount = 2 + next_random(&seed) % (MAX_JOB_NODES - 1);
+        for (k = 0; k < jobs[i].ncount; k++) {
+            jobs[i].x[k] = next_random(&seed) % 1000;
+            jobs[i].y[k] = next_random(&seed) % 1000;
+            jobs[i].z[k] = next_random(&seed) % 1000;
+        }
+        if (solve_job(&jobs[i], jobs[i].serialtour)) {
+            fprintf(stderr, "serial solution of job %d failed\n", i);
+            rval = 1;
+            goto CLEANUP;
+        }
+    }
+
+    for (r = 0; r < repeats; r++) {
+        for (i = 0; i < nthreads; i++) {
+            workers[i].jobs = jobs;
+            workers[i].njobs = njobs;
+            workers[i].first = i;
+            workers[i].step = nthreads;
+            if (pthread_create(&threads[i], NULL, run_worker, &workers[i])) {
+                fprintf(stderr, "pthread_create failed\n");
+                rval = 1;
+                nthreads = i;
+                break;
+            }
+        }
+        for (i = 0; i < nthreads; i++) pthread_join(threads[i], NULL);
+        if (rval) goto CLEANUP;
+
+        for (i = 0; i < njobs; i++) {
+            if (jobs[i].rval || memcmp(jobs[i].tour, jobs[i].serialtour, jobs[i].ncount * sizeof(int))) {
+                fprintf(stderr, "repeat %d: job %d (kind %d, %d nodes) differs from the serial run\n", r,
+                        i, jobs[i].kind, jobs[i].ncount);
+                mismatches++;
+            }
+        }
+    }
+
+    printf("%d jobs solved %d times on %d threads, %d mismatches\n", njobs, repeats, nthreads, mismatches);
+    if (mismatches) rval = 1;
+
+CLEANUP:
+
+    CC_IFFREE(jobs, stress_job);
+    CC_IFFREE(workers, stress_worker);
+    CC_IFFREE(threads, pthread_t);
+    return rval;
+}
+
+/* The coordinates are copied, as TrackMinimization_2D and _3D reorder them */
+static int solve_job(stress_job* job, int* tour) {
+    int x[MAX_JOB_NODES], y[MAX_JOB_NODES], z[MAX_JOB_NODES];
+    int elen[MAX_JOB_NODES * (MAX_JOB_NODES - 1) / 2];
+    int i, j, k;
+    double dx, dy, dz;
+
+    for (i = 0; i < job->ncount; i++) {
+        x[i] = job->x[i];
+        y[i] = job->y[i];
+        z[i] = job->z[i];
+        tour[i] = i;
+    }
+
+    if (job->kind == 0) return TrackMinimization_2D(x, y, job->ncount, tour);
+    if (job->kind == 1) return TrackMinimization_3D(x, y, z, job->ncount, tour);
+
+    for (i = 0, k = 0; i < job->ncount; i++) {
+        for (j = 0; j < i; j++) {
+            dx = x[i] - x[j];
+            dy = y[i] - y[j];
+            dz = z[i] - z[j];
+            elen[k++] = (int)sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    return TrackMinimization_path(job->ncount, elen, tour, 1000000, -1.0);
+}
+
+static void* run_worker(void* arg) {
+    stress_worker* worker = (stress_worker*)arg;
+    int i;
+
+    for (i = worker->first; i < worker->njobs; i += worker->step) {
+        worker->jobs[i].rval = solve_job(&worker->jobs[i], worker->jobs[i].tour);
+    }
+    return NULL;
+}
+
+/* Own generator, so that the jobs do not depend on the C library rand */
+static unsigned int next_random(unsigned int* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (*seed >> 16) & 0x7fff;
+}